@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_ADAPTIVE_MUTEX_
+#define ST_ADAPTIVE_MUTEX_
+#include "adaptive_mutex.h"
+#endif
+
+#define ADAPTIVE_MUTEX_UNLOCKED 0
+#define ADAPTIVE_MUTEX_LOCKED 1
+#define ADAPTIVE_MUTEX_CONTENDED 2
+
+// spin budget is a multiple of average hold time, but not more than max
+#define ADAPTIVE_MUTEX_SPIN_FACTOR 2
+#define ADAPTIVE_MUTEX_MAX_SPIN_CYCLES 20000
+// weight of new sample in moving average is 1 / 2^shift
+#define ADAPTIVE_MUTEX_AVG_SHIFT 3
+
+static inline uint64_t get_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+int adaptive_mutex_init(adaptive_mutex_t *m) {
+    atomic_init(&m->state, ADAPTIVE_MUTEX_UNLOCKED);
+    atomic_init(&m->avg_hold_cycles, 0);
+    m->acquire_timestamp = 0;
+    return 0;
+}
+
+int adaptive_mutex_destroy(adaptive_mutex_t *m) {
+    return atomic_load(&m->state) == ADAPTIVE_MUTEX_UNLOCKED ? 0 : EBUSY;
+}
+
+static inline bool try_acquire(adaptive_mutex_t *m) {
+
+    uint32_t expected_state = ADAPTIVE_MUTEX_UNLOCKED;
+
+    return atomic_compare_exchange_strong_explicit(&m->state, &expected_state, ADAPTIVE_MUTEX_LOCKED,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+/*
+ * Returns 0 on success, EBUSY if mutex is locked
+ */
+int adaptive_mutex_trylock(adaptive_mutex_t *m) {
+
+    if (!try_acquire(m)) {
+        return EBUSY;
+    }
+
+    m->acquire_timestamp = get_cycles();
+
+    return 0;
+}
+
+int adaptive_mutex_lock(adaptive_mutex_t *m) {
+
+    if (try_acquire(m)) {
+        m->acquire_timestamp = get_cycles();
+        return 0;
+    }
+
+    if (should_spin()) {
+
+        uint64_t spin_budget = (uint64_t) atomic_load_explicit(&m->avg_hold_cycles, memory_order_relaxed)
+                               * ADAPTIVE_MUTEX_SPIN_FACTOR;
+
+        if (spin_budget > ADAPTIVE_MUTEX_MAX_SPIN_CYCLES) {
+            spin_budget = ADAPTIVE_MUTEX_MAX_SPIN_CYCLES;
+        }
+
+        uint64_t spin_start = get_cycles();
+
+        while (get_cycles() - spin_start < spin_budget) {
+
+            // read before write, not to steal cache line from owner
+            if (atomic_load_explicit(&m->state, memory_order_relaxed) == ADAPTIVE_MUTEX_UNLOCKED &&
+                try_acquire(m)) {
+                m->acquire_timestamp = get_cycles();
+                return 0;
+            }
+
+            cpu_relax();
+        }
+    }
+
+    // park, marking mutex contended so unlock wakes someone
+    while (atomic_exchange_explicit(&m->state, ADAPTIVE_MUTEX_CONTENDED, memory_order_acquire) != ADAPTIVE_MUTEX_UNLOCKED) {
+        futex_wait(&m->state, ADAPTIVE_MUTEX_CONTENDED);
+    }
+
+    m->acquire_timestamp = get_cycles();
+
+    return 0;
+}
+
+int adaptive_mutex_unlock(adaptive_mutex_t *m) {
+
+    // owner is the only writer, so plain read-modify-write is enough
+    int64_t hold_cycles = get_cycles() - m->acquire_timestamp;
+    int64_t avg_hold_cycles = atomic_load_explicit(&m->avg_hold_cycles, memory_order_relaxed);
+
+    if (hold_cycles > UINT32_MAX) {
+        hold_cycles = UINT32_MAX;
+    }
+
+    avg_hold_cycles += (hold_cycles - avg_hold_cycles) >> ADAPTIVE_MUTEX_AVG_SHIFT;
+    atomic_store_explicit(&m->avg_hold_cycles, (uint32_t) avg_hold_cycles, memory_order_relaxed);
+
+    if (atomic_exchange_explicit(&m->state, ADAPTIVE_MUTEX_UNLOCKED, memory_order_release) == ADAPTIVE_MUTEX_CONTENDED) {
+        futex_wake(&m->state, 1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * Adaptive futex mutex
+ *
+ * State is 0 - unlocked, 1 - locked, 2 - locked and there may be
+ * sleeping threads. Contender spins first and parks on futex only
+ * if lock is not released in time. Spin budget follows average hold
+ * time of recent critical sections: short sections are waited out
+ * by spinning, long ones park right away.
+ *
+ * API follows pthread_mutex_t, so it can replace it in place.
+ */
+typedef struct {
+    futex_word_t state;
+    // exponential moving average of hold time, in cycles
+    _Atomic uint32_t avg_hold_cycles;
+    // written by owner only
+    uint64_t acquire_timestamp;
+} adaptive_mutex_t;
+
+int adaptive_mutex_init(adaptive_mutex_t *m);
+
+int adaptive_mutex_destroy(adaptive_mutex_t *m);
+
+int adaptive_mutex_lock(adaptive_mutex_t *m);
+
+int adaptive_mutex_trylock(adaptive_mutex_t *m);
+
+int adaptive_mutex_unlock(adaptive_mutex_t *m);
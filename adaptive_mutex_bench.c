@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_ADAPTIVE_MUTEX_
+#define ST_ADAPTIVE_MUTEX_
+#include "adaptive_mutex.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define MAX_NUMBER_OF_THREADS 16
+#define BENCH_DURATION_NS 200000000L
+// work inside critical section, roughly a few hundred nanoseconds
+#define CRITICAL_SECTION_WORK 200
+
+typedef struct {
+    bool use_adaptive_mutex;
+    adaptive_mutex_t adaptive_mutex;
+    pthread_mutex_t mutex;
+    atomic_bool is_running;
+    pthread_barrier_t start_barrier;
+    // protected by the mutex under test
+    long shared_counter;
+    volatile long shared_work;
+} mutex_bench_t;
+
+typedef struct {
+    mutex_bench_t *bench;
+    long acquisitions;
+} mutex_worker_input_t;
+
+static void *mutex_worker(void *data) {
+
+    mutex_worker_input_t *input = (mutex_worker_input_t*) data;
+    mutex_bench_t *bench = input->bench;
+
+    pthread_barrier_wait(&bench->start_barrier);
+
+    while (atomic_load_explicit(&bench->is_running, memory_order_relaxed)) {
+
+        if (bench->use_adaptive_mutex) {
+            adaptive_mutex_lock(&bench->adaptive_mutex);
+        } else {
+            pthread_mutex_lock(&bench->mutex);
+        }
+
+        ++bench->shared_counter;
+        for (int i = 0; i < CRITICAL_SECTION_WORK; ++i) {
+            bench->shared_work += i;
+        }
+
+        if (bench->use_adaptive_mutex) {
+            adaptive_mutex_unlock(&bench->adaptive_mutex);
+        } else {
+            pthread_mutex_unlock(&bench->mutex);
+        }
+
+        ++input->acquisitions;
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 if mutex has protected shared counter
+ */
+int bench_mutex(bool use_adaptive_mutex, int number_of_threads) {
+
+    mutex_bench_t bench;
+    bench.use_adaptive_mutex = use_adaptive_mutex;
+    adaptive_mutex_init(&bench.adaptive_mutex);
+    pthread_mutex_init(&bench.mutex, NULL);
+    atomic_init(&bench.is_running, true);
+    pthread_barrier_init(&bench.start_barrier, NULL, number_of_threads + 1);
+    bench.shared_counter = 0;
+    bench.shared_work = 0;
+
+    pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+    mutex_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+    for (int i = 0; i < number_of_threads; ++i) {
+        inputs[i].bench = &bench;
+        inputs[i].acquisitions = 0;
+        pthread_create(thread_ids + i, NULL, mutex_worker, inputs + i);
+    }
+
+    pthread_barrier_wait(&bench.start_barrier);
+
+    struct timespec duration = { 0, BENCH_DURATION_NS };
+    nanosleep(&duration, NULL);
+
+    atomic_store(&bench.is_running, false);
+
+    long acquisitions = 0;
+    for (int i = 0; i < number_of_threads; ++i) {
+        pthread_join(thread_ids[i], NULL);
+        acquisitions += inputs[i].acquisitions;
+    }
+
+    printf("%-16s threads=%2d: %8.2f M acquisitions/s\n",
+           use_adaptive_mutex ? "adaptive_mutex_t" : "pthread_mutex_t", number_of_threads,
+           acquisitions / (BENCH_DURATION_NS * 1e-9) * 1e-6);
+
+    pthread_barrier_destroy(&bench.start_barrier);
+    pthread_mutex_destroy(&bench.mutex);
+    adaptive_mutex_destroy(&bench.adaptive_mutex);
+
+    return bench.shared_counter == acquisitions ? 0 : 1;
+}
+
+int main() {
+
+    int result = 0;
+
+    for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+        result |= bench_mutex(false, n);
+        result |= bench_mutex(true, n);
+    }
+
+    printf(result ? "Failure\n" : "Success\n");
+
+    return result;
+}
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_BARRIER_
+#define ST_BARRIER_
+#include "barrier.h"
+#endif
+
+// spins of waiter before parking on futex
+#define BARRIER_SPIN_LIMIT 1000
+
+static void init_barrier_release(barrier_release_t *release) {
+    atomic_init(&release->generation, 0);
+    atomic_init(&release->number_of_sleepers, 0);
+}
+
+/*
+ * Generation bump and sleepers check are seq_cst, as well as sleepers
+ * increment and generation recheck of waiter: either waiter sees new
+ * generation, or last arriver sees the sleeper.
+ */
+static void release_waiters(barrier_release_t *release) {
+
+    atomic_fetch_add_explicit(&release->generation, 1, memory_order_seq_cst);
+
+    if (atomic_load_explicit(&release->number_of_sleepers, memory_order_seq_cst)) {
+        futex_wake(&release->generation, INT_MAX);
+    }
+}
+
+static void wait_for_release(barrier_release_t *release, uint32_t generation) {
+
+    int spin_limit = should_spin() ? BARRIER_SPIN_LIMIT : 0;
+
+    for (int i = 0; i < spin_limit; ++i) {
+
+        if (atomic_load_explicit(&release->generation, memory_order_acquire) != generation) {
+            return;
+        }
+
+        cpu_relax();
+    }
+
+    atomic_fetch_add_explicit(&release->number_of_sleepers, 1, memory_order_seq_cst);
+
+    while (atomic_load_explicit(&release->generation, memory_order_seq_cst) == generation) {
+        futex_wait(&release->generation, generation);
+    }
+
+    atomic_fetch_sub_explicit(&release->number_of_sleepers, 1, memory_order_relaxed);
+}
+
+sense_barrier_t *init_sense_barrier(uint32_t number_of_threads) {
+
+    sense_barrier_t *barrier = (sense_barrier_t*) aligned_alloc(BARRIER_CACHE_LINE_SIZE, sizeof(sense_barrier_t));
+
+    if (!barrier) {
+        return NULL;
+    }
+
+    atomic_init(&barrier->number_of_arrived, 0);
+    barrier->number_of_threads = number_of_threads;
+    init_barrier_release(&barrier->release);
+
+    return barrier;
+}
+
+/*
+ * Function assumes nobody waits on barrier
+ */
+void close_sense_barrier(sense_barrier_t *barrier) {
+    free(barrier);
+}
+
+/*
+ * Returns BARRIER_SERIAL_THREAD to the last arriver, 0 to others
+ */
+int sense_barrier_wait(sense_barrier_t *barrier) {
+
+    // generation can not change until this thread arrives
+    uint32_t generation = atomic_load_explicit(&barrier->release.generation, memory_order_acquire);
+
+    uint32_t number_of_arrived = atomic_fetch_add_explicit(&barrier->number_of_arrived, 1, memory_order_acq_rel) + 1;
+
+    if (number_of_arrived == barrier->number_of_threads) {
+        // nobody touches counter until release, so reset is safe
+        atomic_store_explicit(&barrier->number_of_arrived, 0, memory_order_relaxed);
+        release_waiters(&barrier->release);
+        return BARRIER_SERIAL_THREAD;
+    }
+
+    wait_for_release(&barrier->release, generation);
+
+    return 0;
+}
+
+/*
+ * Tree is stored level by level starting from leaves,
+ * thread i arrives at leaf i / BARRIER_TREE_FAN_IN
+ */
+combining_barrier_t *init_combining_barrier(uint32_t number_of_threads) {
+
+    combining_barrier_t *barrier = (combining_barrier_t*) aligned_alloc(BARRIER_CACHE_LINE_SIZE,
+                                                                       sizeof(combining_barrier_t));
+
+    if (!barrier) {
+        return NULL;
+    }
+
+    uint32_t number_of_nodes = 0;
+    for (uint32_t level_size = number_of_threads; level_size > 1; ) {
+        level_size = (level_size + BARRIER_TREE_FAN_IN - 1) / BARRIER_TREE_FAN_IN;
+        number_of_nodes += level_size;
+    }
+
+    // single thread still needs a root to arrive at
+    if (!number_of_nodes) {
+        number_of_nodes = 1;
+    }
+
+    barrier->nodes = (combining_node_t*) aligned_alloc(BARRIER_CACHE_LINE_SIZE,
+                                                       sizeof(combining_node_t) * number_of_nodes);
+
+    if (!barrier->nodes) {
+        free(barrier);
+        return NULL;
+    }
+
+    // children of level are threads first, then nodes of previous level
+    uint32_t number_of_children = number_of_threads;
+    combining_node_t *level = barrier->nodes;
+
+    do {
+        uint32_t level_size = (number_of_children + BARRIER_TREE_FAN_IN - 1) / BARRIER_TREE_FAN_IN;
+        combining_node_t *next_level = level + level_size;
+
+        for (uint32_t i = 0; i < level_size; ++i) {
+
+            uint32_t first_child = i * BARRIER_TREE_FAN_IN;
+            uint32_t last_child = first_child + BARRIER_TREE_FAN_IN;
+
+            atomic_init(&level[i].number_of_arrived, 0);
+            level[i].number_of_children = (last_child < number_of_children ? last_child : number_of_children) - first_child;
+            level[i].parent = level_size > 1 ? next_level + i / BARRIER_TREE_FAN_IN : NULL;
+        }
+
+        number_of_children = level_size;
+        level = next_level;
+
+    } while (number_of_children > 1);
+
+    barrier->number_of_threads = number_of_threads;
+    init_barrier_release(&barrier->release);
+
+    return barrier;
+}
+
+/*
+ * Function assumes nobody waits on barrier
+ */
+void close_combining_barrier(combining_barrier_t *barrier) {
+    free(barrier->nodes);
+    free(barrier);
+}
+
+/*
+ * thread_index should be unique among threads of barrier, in [0, number_of_threads)
+ *
+ * Returns BARRIER_SERIAL_THREAD to the thread, which completes the root,
+ * 0 to others
+ */
+int combining_barrier_wait(combining_barrier_t *barrier, uint32_t thread_index) {
+
+    uint32_t generation = atomic_load_explicit(&barrier->release.generation, memory_order_acquire);
+
+    combining_node_t *node = barrier->nodes + thread_index / BARRIER_TREE_FAN_IN;
+
+    for (;;) {
+
+        uint32_t number_of_arrived = atomic_fetch_add_explicit(&node->number_of_arrived, 1, memory_order_acq_rel) + 1;
+
+        // someone else climbs further
+        if (number_of_arrived != node->number_of_children) {
+            wait_for_release(&barrier->release, generation);
+            return 0;
+        }
+
+        atomic_store_explicit(&node->number_of_arrived, 0, memory_order_relaxed);
+
+        if (!node->parent) {
+            release_waiters(&barrier->release);
+            return BARRIER_SERIAL_THREAD;
+        }
+
+        node = node->parent;
+    }
+}
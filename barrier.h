@@ -0,0 +1,58 @@
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Reusable barriers for bulk-synchronous phases
+ *
+ * Both barriers release waiters by bumping generation, waiter
+ * remembers generation before arrival and waits until it changes,
+ * which is sense reversal without per-thread sense. Waiters spin for
+ * a while and then park on generation futex, last arriver wakes them
+ * only if someone sleeps.
+ *
+ * sense_barrier_t     - all threads arrive on one counter.
+ * combining_barrier_t - threads arrive on leaves of a tree with
+ *                       cache line padded nodes, last arriver of node
+ *                       climbs to its parent, so each counter is
+ *                       touched by fan-in threads only.
+ */
+#define BARRIER_CACHE_LINE_SIZE 64
+#define BARRIER_TREE_FAN_IN 4
+
+// returned to exactly one thread of each phase, as PTHREAD_BARRIER_SERIAL_THREAD
+#define BARRIER_SERIAL_THREAD -1
+
+typedef struct {
+    _Alignas(BARRIER_CACHE_LINE_SIZE) futex_word_t generation;
+    _Atomic uint32_t number_of_sleepers;
+} barrier_release_t;
+
+typedef struct {
+    _Alignas(BARRIER_CACHE_LINE_SIZE) _Atomic uint32_t number_of_arrived;
+    uint32_t number_of_threads;
+    barrier_release_t release;
+} sense_barrier_t;
+
+typedef struct combining_node_ {
+    _Alignas(BARRIER_CACHE_LINE_SIZE) _Atomic uint32_t number_of_arrived;
+    uint32_t number_of_children;
+    struct combining_node_ *parent;
+} combining_node_t;
+
+typedef struct {
+    combining_node_t *nodes;
+    uint32_t number_of_threads;
+    barrier_release_t release;
+} combining_barrier_t;
+
+sense_barrier_t *init_sense_barrier(uint32_t number_of_threads);
+
+void close_sense_barrier(sense_barrier_t *barrier);
+
+int sense_barrier_wait(sense_barrier_t *barrier);
+
+combining_barrier_t *init_combining_barrier(uint32_t number_of_threads);
+
+void close_combining_barrier(combining_barrier_t *barrier);
+
+int combining_barrier_wait(combining_barrier_t *barrier, uint32_t thread_index);
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_BARRIER_
+#define ST_BARRIER_
+#include "barrier.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define MAX_NUMBER_OF_THREADS 64
+#define NUMBER_OF_PHASES 2000
+
+typedef enum {
+    PTHREAD_BARRIER,
+    SENSE_BARRIER,
+    COMBINING_BARRIER
+} barrier_kind_t;
+
+static const char *barrier_kind_names[] = {
+    "pthread_barrier_t",
+    "sense_barrier_t",
+    "combining_barrier_t"
+};
+
+typedef struct {
+    barrier_kind_t kind;
+    pthread_barrier_t pthread_barrier;
+    sense_barrier_t *sense_barrier;
+    combining_barrier_t *combining_barrier;
+    // every thread increments its own slot each phase
+    _Atomic long phase_counters[MAX_NUMBER_OF_THREADS];
+    _Atomic long number_of_errors;
+    uint32_t number_of_threads;
+} barrier_bench_t;
+
+typedef struct {
+    barrier_bench_t *bench;
+    uint32_t thread_index;
+} barrier_worker_input_t;
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static void bench_barrier_wait(barrier_bench_t *bench, uint32_t thread_index) {
+    switch (bench->kind) {
+    case PTHREAD_BARRIER:
+        pthread_barrier_wait(&bench->pthread_barrier);
+        break;
+    case SENSE_BARRIER:
+        sense_barrier_wait(bench->sense_barrier);
+        break;
+    case COMBINING_BARRIER:
+        combining_barrier_wait(bench->combining_barrier, thread_index);
+        break;
+    }
+}
+
+/*
+ * After each barrier every thread should see all others in the same phase
+ */
+static void *barrier_worker(void *data) {
+
+    barrier_worker_input_t *input = (barrier_worker_input_t*) data;
+    barrier_bench_t *bench = input->bench;
+
+    for (long phase = 1; phase <= NUMBER_OF_PHASES; ++phase) {
+
+        atomic_store_explicit(bench->phase_counters + input->thread_index, phase, memory_order_relaxed);
+
+        bench_barrier_wait(bench, input->thread_index);
+
+        // check a neighbour only, checking all is quadratic
+        uint32_t neighbour_index = (input->thread_index + 1) % bench->number_of_threads;
+        if (atomic_load_explicit(bench->phase_counters + neighbour_index, memory_order_relaxed) < phase) {
+            atomic_fetch_add(&bench->number_of_errors, 1);
+        }
+
+        // nobody may start next phase until everyone has checked this one
+        bench_barrier_wait(bench, input->thread_index);
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 if no thread has passed barrier too early
+ */
+int bench_barrier(barrier_kind_t kind, uint32_t number_of_threads) {
+
+    barrier_bench_t bench;
+    bench.kind = kind;
+    bench.number_of_threads = number_of_threads;
+    pthread_barrier_init(&bench.pthread_barrier, NULL, number_of_threads);
+    bench.sense_barrier = init_sense_barrier(number_of_threads);
+    bench.combining_barrier = init_combining_barrier(number_of_threads);
+    atomic_init(&bench.number_of_errors, 0);
+
+    for (uint32_t i = 0; i < number_of_threads; ++i) {
+        atomic_init(bench.phase_counters + i, 0);
+    }
+
+    pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+    barrier_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t i = 0; i < number_of_threads; ++i) {
+        inputs[i] = (barrier_worker_input_t) { &bench, i };
+        pthread_create(thread_ids + i, NULL, barrier_worker, inputs + i);
+    }
+
+    for (uint32_t i = 0; i < number_of_threads; ++i) {
+        pthread_join(thread_ids[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%-19s threads=%2u: %10.2f us/barrier\n",
+           barrier_kind_names[kind], number_of_threads,
+           get_time_diff_sec(&start, &end) / (2 * NUMBER_OF_PHASES) * 1e6);
+
+    close_combining_barrier(bench.combining_barrier);
+    close_sense_barrier(bench.sense_barrier);
+    pthread_barrier_destroy(&bench.pthread_barrier);
+
+    return atomic_load(&bench.number_of_errors) ? 1 : 0;
+}
+
+int main() {
+
+    int result = 0;
+
+    for (uint32_t n = 2; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+        result |= bench_barrier(PTHREAD_BARRIER, n);
+        result |= bench_barrier(SENSE_BARRIER, n);
+        result |= bench_barrier(COMBINING_BARRIER, n);
+    }
+
+    printf(result ? "Failure\n" : "Success\n");
+
+    return result;
+}
@@ -1,37 +1,127 @@
 #include <stdlib.h>
-#include <pthread.h>
 #include <stdbool.h>
+#include <errno.h>
 
-typedef struct cv_node_ {
-    pthread_mutex_t *dynamic;
-    bool is_awaken;
-    struct cv_node_ *next;
-} cv_node;
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
 
-typedef struct {
-    cv_node *head;
-} cond_t;
+#ifndef ST_CV_
+#define ST_CV_
+#include "cv.h"
+#endif
+
+// Waiter is in queue
+#define CV_NODE_WAITING 0
+// Waiter is dequeued and may leave
+#define CV_NODE_SIGNALED 1
+// Waiter is dequeued and moved to mutex futex
+#define CV_NODE_REQUEUED 2
+
+#define CV_MUTEX_UNLOCKED 0
+#define CV_MUTEX_LOCKED 1
+#define CV_MUTEX_CONTENDED 2
+
+#define CV_SPIN_LIMIT 100
+
+void cv_mutex_init(cv_mutex_t *m) {
+    atomic_init(&m->state, CV_MUTEX_UNLOCKED);
+}
+
+/*
+ * Locks mutex marking it contended, so unlock always wakes next sleeper
+ */
+static void cv_mutex_lock_contended(cv_mutex_t *m) {
+    while (atomic_exchange_explicit(&m->state, CV_MUTEX_CONTENDED, memory_order_acquire) != CV_MUTEX_UNLOCKED) {
+        futex_wait(&m->state, CV_MUTEX_CONTENDED);
+    }
+}
+
+void cv_mutex_lock(cv_mutex_t *m) {
+
+    uint32_t expected_state = CV_MUTEX_UNLOCKED;
+
+    if (atomic_compare_exchange_strong_explicit(&m->state, &expected_state, CV_MUTEX_LOCKED,
+                                                memory_order_acquire, memory_order_relaxed)) {
+        return;
+    }
+
+    cv_mutex_lock_contended(m);
+}
+
+void cv_mutex_unlock(cv_mutex_t *m) {
+    if (atomic_exchange_explicit(&m->state, CV_MUTEX_UNLOCKED, memory_order_release) == CV_MUTEX_CONTENDED) {
+        futex_wake(&m->state, 1);
+    }
+}
+
+/*
+ * Moves thread sleeping on word to mutex futex without waking it
+ *
+ * Returns number of moved threads
+ */
+static long futex_requeue_to_mutex(futex_word_t *word, uint32_t expected, cv_mutex_t *m) {
+    return syscall(SYS_futex, word, FUTEX_CMP_REQUEUE_PRIVATE, 0, (void*) 1, &m->state, expected);
+}
 
 cond_t *cond_init() {
-    
+
     cond_t *result_cond = (cond_t*) malloc(sizeof(cond_t));
 
+    if (!result_cond) {
+        return NULL;
+    }
+
+    atomic_flag_clear(&result_cond->queue_lock);
     result_cond->head = NULL;
+    result_cond->tail = NULL;
+    result_cond->mutex = NULL;
 
     return result_cond;
 }
 
+/*
+ * Function assumes there are no waiters
+ */
 void cond_destroy(cond_t *cv) {
-    // TODO: destroy all cv nodes may be
     free(cv);
 }
 
+static inline void lock_queue(cond_t *cv) {
+    unsigned int spin_counter = 0;
+
+    while (atomic_flag_test_and_set_explicit(&cv->queue_lock, memory_order_acquire)) {
+        spin_wait_step(&spin_counter, CV_SPIN_LIMIT);
+    }
+}
+
+static inline void unlock_queue(cond_t *cv) {
+    atomic_flag_clear_explicit(&cv->queue_lock, memory_order_release);
+}
+
+/*
+ * Function assumes queue lock is held
+ */
+static void append_to_linked_list(cond_t *cv, cv_node *new_cv_node_ptr) {
+
+    new_cv_node_ptr->prev = cv->tail;
+    new_cv_node_ptr->next = NULL;
+
+    if (cv->tail) {
+        cv->tail->next = new_cv_node_ptr;
+    } else {
+        cv->head = new_cv_node_ptr;
+    }
+
+    cv->tail = new_cv_node_ptr;
+}
+
 /*
- * Function assumes mutex is locked
- * 
+ * Function assumes queue lock is held
+ *
  * Error codes:
  * 0 - success
- * 1 - cv_node is not found
  * 2 - invalid input
 */
 static int remove_from_linked_list(cond_t *cv, cv_node *target_cv_node_ptr) {
@@ -41,44 +131,206 @@ static int remove_from_linked_list(cond_t *cv, cv_node *target_cv_node_ptr) {
         return 2;
     }
 
-    if (target_cv_node_ptr == cv->head) {
-        cv->head = cv->head->next;
-        return 0;
+    if (target_cv_node_ptr->prev) {
+        target_cv_node_ptr->prev->next = target_cv_node_ptr->next;
+    } else {
+        cv->head = target_cv_node_ptr->next;
     }
 
-    for (
-        cv_node *prev_cv_node_ptr;
-        prev_cv_node_ptr->next != NULL;
-        prev_cv_node_ptr = prev_cv_node_ptr->next) {
+    if (target_cv_node_ptr->next) {
+        target_cv_node_ptr->next->prev = target_cv_node_ptr->prev;
+    } else {
+        cv->tail = target_cv_node_ptr->prev;
+    }
 
-            if (prev_cv_node_ptr->next == target_cv_node_ptr) {
-                prev_cv_node_ptr->next = prev_cv_node_ptr->next->next;
-                return 0;
-            }
+    return 0;
+}
+
+/*
+ * Function assumes queue lock is held
+ *
+ * Once node is signaled waiter may return and its node may go away,
+ * so it is not touched after that. Futex wake of such stale address
+ * is harmless: waiters always recheck their state after wake up.
+ */
+static cv_node *pop_from_linked_list(cond_t *cv) {
+
+    cv_node *first_cv_node_ptr = cv->head;
+
+    if (first_cv_node_ptr) {
+        remove_from_linked_list(cv, first_cv_node_ptr);
+        atomic_store_explicit(&first_cv_node_ptr->state, CV_NODE_SIGNALED, memory_order_release);
     }
 
-    return 1;
+    return first_cv_node_ptr;
 }
 
-// TODO
-void cond_wait(cond_t *cv, pthread_mutex_t *m) {
+/*
+ * Function assumes mutex is locked, it is locked again on return
+ *
+ * abstime is absolute CLOCK_MONOTONIC time, NULL means no timeout
+ *
+ * Error codes:
+ * 0         - success
+ * ETIMEDOUT - time is out before signal
+*/
+int cond_timedwait(cond_t *cv, cv_mutex_t *m, const struct timespec *abstime) {
+
+    int result = 0;
+    cv_node self_cv_node;
 
+    atomic_init(&self_cv_node.state, CV_NODE_WAITING);
+
+    lock_queue(cv);
+    cv->mutex = m;
+    append_to_linked_list(cv, &self_cv_node);
+    unlock_queue(cv);
+
+    cv_mutex_unlock(m);
+
+    while (atomic_load_explicit(&self_cv_node.state, memory_order_acquire) == CV_NODE_WAITING) {
+
+        if (futex_wait_until(&self_cv_node.state, CV_NODE_WAITING, abstime) == -1 && errno == ETIMEDOUT) {
+
+            lock_queue(cv);
+
+            // signal may come right after timeout, then it is consumed
+            if (atomic_load_explicit(&self_cv_node.state, memory_order_relaxed) == CV_NODE_WAITING) {
+                remove_from_linked_list(cv, &self_cv_node);
+                result = ETIMEDOUT;
+            }
+
+            unlock_queue(cv);
+            break;
+        }
+    }
+
+    // requeued waiter is woken by unlock, it should wake next one in turn
+    if (atomic_load_explicit(&self_cv_node.state, memory_order_relaxed) == CV_NODE_REQUEUED) {
+        cv_mutex_lock_contended(m);
+    } else {
+        cv_mutex_lock(m);
+    }
+
+    return result;
 }
 
-// TODO
+int cond_wait(cond_t *cv, cv_mutex_t *m) {
+    return cond_timedwait(cv, m, NULL);
+}
+
+/*
+ * Wakes the longest waiting thread, if any
+ */
 void cond_signal(cond_t *cv) {
 
+    lock_queue(cv);
+    cv_node *cv_node_ptr = pop_from_linked_list(cv);
+    unlock_queue(cv);
+
+    if (cv_node_ptr) {
+        futex_wake(&cv_node_ptr->state, 1);
+    }
 }
 
-// TODO
+/*
+ * Wakes one waiter and moves all others to the mutex futex
+ *
+ * Requeued waiters are woken one by one by mutex unlocks instead of
+ * waking all at once and fighting for the mutex. First waiter is woken
+ * after all others are requeued and locks mutex as contended, so the
+ * chain of unlock wake ups can not be lost.
+ *
+ * Nodes are handled under queue lock: signaled node may go away, so
+ * the queue can not be walked outside of it
+ */
 void cond_broadcast(cond_t *cv) {
 
+    lock_queue(cv);
+
+    cv_node *first_cv_node_ptr = cv->head;
+
+    if (!first_cv_node_ptr) {
+        unlock_queue(cv);
+        return;
+    }
+
+    remove_from_linked_list(cv, first_cv_node_ptr);
+
+    // first waiter has to lock mutex as contended only if someone is requeued
+    uint32_t first_cv_node_state = cv->head ? CV_NODE_REQUEUED : CV_NODE_SIGNALED;
+
+    while (cv->head) {
+
+        cv_node *cv_node_ptr = cv->head;
+        remove_from_linked_list(cv, cv_node_ptr);
+
+        // waiter, that has not slept yet, sees new state and does not sleep
+        atomic_store_explicit(&cv_node_ptr->state, CV_NODE_REQUEUED, memory_order_release);
+        futex_requeue_to_mutex(&cv_node_ptr->state, CV_NODE_REQUEUED, cv->mutex);
+    }
+
+    atomic_store_explicit(&first_cv_node_ptr->state, first_cv_node_state, memory_order_release);
+    futex_wake(&first_cv_node_ptr->state, 1);
+
+    unlock_queue(cv);
+}
+
+/*
+ * Wakes all waiting threads at once, they compete for the mutex
+ *
+ * Kept for comparison with cond_broadcast
+ */
+void cond_broadcast_wake_all(cond_t *cv) {
+
+    lock_queue(cv);
+
+    cv_node *cv_node_ptr;
+    while ((cv_node_ptr = pop_from_linked_list(cv))) {
+        futex_wake(&cv_node_ptr->state, 1);
+    }
+
+    unlock_queue(cv);
+}
+
+void eventcount_init(eventcount_t *ec) {
+    atomic_init(&ec->epoch, 0);
+    atomic_init(&ec->waiters, 0);
+}
+
+/*
+ * Announces waiter, condition should be checked after it
+ *
+ * Returns key for eventcount_commit_wait
+ */
+uint32_t eventcount_prepare_wait(eventcount_t *ec) {
+    atomic_fetch_add_explicit(&ec->waiters, 1, memory_order_seq_cst);
+    return atomic_load_explicit(&ec->epoch, memory_order_seq_cst);
+}
+
+/*
+ * Withdraws waiter, when condition turned out to be true
+ */
+void eventcount_cancel_wait(eventcount_t *ec) {
+    atomic_fetch_sub_explicit(&ec->waiters, 1, memory_order_relaxed);
 }
 
-int main() {
+/*
+ * Sleeps until any notify after matching eventcount_prepare_wait
+ */
+void eventcount_commit_wait(eventcount_t *ec, uint32_t key) {
 
-    cond_t *cv = cond_init();
+    while (atomic_load_explicit(&ec->epoch, memory_order_acquire) == key) {
+        futex_wait(&ec->epoch, key);
+    }
 
-    cond_destroy(cv);
+    atomic_fetch_sub_explicit(&ec->waiters, 1, memory_order_relaxed);
+}
 
-}
\ No newline at end of file
+/*
+ * Slow path of eventcount_notify
+ */
+void eventcount_notify_waiters(eventcount_t *ec) {
+    atomic_fetch_add_explicit(&ec->epoch, 1, memory_order_release);
+    futex_wake(&ec->epoch, INT32_MAX);
+}
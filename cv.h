@@ -0,0 +1,98 @@
+/*
+ * Futex mutex, companion of cond_t
+ *
+ * State is 0 - unlocked, 1 - locked, 2 - locked and there may be
+ * sleeping threads. Broadcast moves waiters of condition variable
+ * straight onto state futex instead of waking them.
+ */
+typedef struct {
+    futex_word_t state;
+} cv_mutex_t;
+
+/*
+ * Waiter of condition variable
+ *
+ * Node lives on waiter's stack, each waiter sleeps on its own futex
+ * word, so signal wakes exactly the thread it has dequeued.
+ */
+typedef struct cv_node_ {
+    futex_word_t state;
+    struct cv_node_ *prev;
+    struct cv_node_ *next;
+} cv_node;
+
+/*
+ * Condition variable with FIFO queue of waiters
+ */
+typedef struct {
+    // protects queue of waiters
+    atomic_flag queue_lock;
+    cv_node *head;
+    cv_node *tail;
+    // mutex passed by waiters, all of them must use the same one
+    cv_mutex_t *mutex;
+} cond_t;
+
+void cv_mutex_init(cv_mutex_t *m);
+
+void cv_mutex_lock(cv_mutex_t *m);
+
+void cv_mutex_unlock(cv_mutex_t *m);
+
+cond_t *cond_init();
+
+void cond_destroy(cond_t *cv);
+
+int cond_wait(cond_t *cv, cv_mutex_t *m);
+
+int cond_timedwait(cond_t *cv, cv_mutex_t *m, const struct timespec *abstime);
+
+void cond_signal(cond_t *cv);
+
+void cond_broadcast(cond_t *cv);
+
+void cond_broadcast_wake_all(cond_t *cv);
+
+/*
+ * Eventcount, lets consumers of lock-free structures sleep until
+ * producer reports an event, without lock on producer's side
+ *
+ * Consumer:
+ *     key = eventcount_prepare_wait(ec);
+ *     if (condition is true) { eventcount_cancel_wait(ec); ... }
+ *     else eventcount_commit_wait(ec, key);
+ *
+ * Producer makes condition true and calls eventcount_notify(ec).
+ */
+typedef struct {
+    // bumped by every notify, waiters sleep on it
+    futex_word_t epoch;
+    // number of threads between prepare_wait and end of wait
+    _Atomic uint32_t waiters;
+} eventcount_t;
+
+void eventcount_init(eventcount_t *ec);
+
+uint32_t eventcount_prepare_wait(eventcount_t *ec);
+
+void eventcount_cancel_wait(eventcount_t *ec);
+
+void eventcount_commit_wait(eventcount_t *ec, uint32_t key);
+
+void eventcount_notify_waiters(eventcount_t *ec);
+
+/*
+ * Wakes all threads waiting for event
+ *
+ * Fence orders producer's store before waiters check. It pairs with
+ * seq_cst increment in eventcount_prepare_wait: either producer sees
+ * the waiter, or waiter sees producer's store. Without waiters the
+ * cost is this fence and one load.
+ */
+static inline void eventcount_notify(eventcount_t *ec) {
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&ec->waiters, memory_order_relaxed)) {
+        eventcount_notify_waiters(ec);
+    }
+}
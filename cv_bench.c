@@ -0,0 +1,423 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_CV_
+#define ST_CV_
+#include "cv.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define PING_PONG_ROUNDS 100000
+#define TIMED_WAIT_NS 10000000
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t pthread_cv;
+    cv_mutex_t cv_mutex;
+    cond_t *cv;
+    bool use_pthread_cond;
+    int turn;
+} ping_pong_t;
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+static void ping_pong_wait(ping_pong_t *pp) {
+    if (pp->use_pthread_cond) {
+        pthread_cond_wait(&pp->pthread_cv, &pp->mutex);
+    } else {
+        cond_wait(pp->cv, &pp->cv_mutex);
+    }
+}
+
+static void ping_pong_lock(ping_pong_t *pp) {
+    if (pp->use_pthread_cond) {
+        pthread_mutex_lock(&pp->mutex);
+    } else {
+        cv_mutex_lock(&pp->cv_mutex);
+    }
+}
+
+static void ping_pong_unlock(ping_pong_t *pp) {
+    if (pp->use_pthread_cond) {
+        pthread_mutex_unlock(&pp->mutex);
+    } else {
+        cv_mutex_unlock(&pp->cv_mutex);
+    }
+}
+
+static void ping_pong_signal(ping_pong_t *pp) {
+    if (pp->use_pthread_cond) {
+        pthread_cond_signal(&pp->pthread_cv);
+    } else {
+        cond_signal(pp->cv);
+    }
+}
+
+/*
+ * Player passes turn to the other one and waits for it back
+ */
+static void play_ping_pong(ping_pong_t *pp, int self) {
+
+    ping_pong_lock(pp);
+
+    for (int i = 0; i < PING_PONG_ROUNDS; ++i) {
+
+        while (pp->turn != self) {
+            ping_pong_wait(pp);
+        }
+
+        pp->turn = !self;
+        ping_pong_signal(pp);
+    }
+
+    ping_pong_unlock(pp);
+}
+
+static void *pong_worker(void *data) {
+    play_ping_pong((ping_pong_t*) data, 1);
+    return NULL;
+}
+
+void bench_ping_pong(bool use_pthread_cond) {
+
+    ping_pong_t pp;
+
+    pthread_mutex_init(&pp.mutex, NULL);
+    pthread_cond_init(&pp.pthread_cv, NULL);
+    cv_mutex_init(&pp.cv_mutex);
+    pp.cv = cond_init();
+    pp.use_pthread_cond = use_pthread_cond;
+    pp.turn = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pthread_t pong_thread;
+    pthread_create(&pong_thread, NULL, pong_worker, &pp);
+
+    play_ping_pong(&pp, 0);
+
+    pthread_join(pong_thread, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%-14s ping-pong: %8.2f ns/round trip\n",
+           use_pthread_cond ? "pthread_cond_t" : "cond_t",
+           get_time_diff_sec(&start, &end) / PING_PONG_ROUNDS * 1e9);
+
+    cond_destroy(pp.cv);
+    pthread_cond_destroy(&pp.pthread_cv);
+    pthread_mutex_destroy(&pp.mutex);
+}
+
+/*
+ * Nobody signals, so wait should time out not earlier than requested
+ */
+int test_timed_wait() {
+
+    cv_mutex_t mutex;
+    cv_mutex_init(&mutex);
+    cond_t *cv = cond_init();
+
+    struct timespec start, deadline, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    deadline = start;
+    deadline.tv_nsec += TIMED_WAIT_NS;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    cv_mutex_lock(&mutex);
+    int result = cond_timedwait(cv, &mutex, &deadline);
+    cv_mutex_unlock(&mutex);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    bool is_queue_empty = cv->head == NULL && cv->tail == NULL;
+
+    cond_destroy(cv);
+
+    if (result != ETIMEDOUT || get_time_diff_sec(&start, &end) < TIMED_WAIT_NS * 1e-9 || !is_queue_empty) {
+        printf("test_timed_wait: Failure\n");
+        return 1;
+    }
+
+    printf("test_timed_wait: Success\n");
+
+    return 0;
+}
+
+#define BROADCAST_WAITERS 64
+#define BROADCAST_ROUNDS 50
+
+typedef struct {
+    cv_mutex_t mutex;
+    cond_t *cv;
+    int generation;
+    int waiting;
+    int woken;
+    struct timespec broadcast_time;
+    double total_latency;
+    double max_latency;
+} broadcast_test_t;
+
+static void *broadcast_waiter(void *data) {
+
+    broadcast_test_t *bt = (broadcast_test_t*) data;
+
+    for (int round = 1; round <= BROADCAST_ROUNDS; ++round) {
+
+        cv_mutex_lock(&bt->mutex);
+
+        ++bt->waiting;
+        while (bt->generation < round) {
+            cond_wait(bt->cv, &bt->mutex);
+        }
+
+        // time from broadcast to owning the mutex
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        double latency = get_time_diff_sec(&bt->broadcast_time, &now);
+        bt->total_latency += latency;
+        bt->max_latency = latency > bt->max_latency ? latency : bt->max_latency;
+        ++bt->woken;
+
+        cv_mutex_unlock(&bt->mutex);
+    }
+
+    return NULL;
+}
+
+static long get_context_switches() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+/*
+ * 64 waiters are released by broadcast, round after round
+ *
+ * Returns 0 if every waiter has left every round
+ */
+int bench_broadcast(bool use_requeue) {
+
+    broadcast_test_t bt;
+    cv_mutex_init(&bt.mutex);
+    bt.cv = cond_init();
+    bt.generation = 0;
+    bt.waiting = 0;
+    bt.woken = 0;
+    bt.total_latency = 0;
+    bt.max_latency = 0;
+
+    pthread_t thread_ids[BROADCAST_WAITERS];
+
+    for (int i = 0; i < BROADCAST_WAITERS; ++i) {
+        pthread_create(thread_ids + i, NULL, broadcast_waiter, &bt);
+    }
+
+    long context_switches = 0;
+
+    for (int round = 1; round <= BROADCAST_ROUNDS; ++round) {
+
+        // wait until all waiters of this round are sleeping
+        for (;;) {
+            cv_mutex_lock(&bt.mutex);
+            bool is_everyone_waiting = bt.waiting == BROADCAST_WAITERS * round;
+            cv_mutex_unlock(&bt.mutex);
+
+            if (is_everyone_waiting) {
+                break;
+            }
+            usleep(100);
+        }
+
+        long context_switches_before = get_context_switches();
+
+        cv_mutex_lock(&bt.mutex);
+        bt.generation = round;
+        clock_gettime(CLOCK_MONOTONIC, &bt.broadcast_time);
+
+        if (use_requeue) {
+            cond_broadcast(bt.cv);
+        } else {
+            cond_broadcast_wake_all(bt.cv);
+        }
+
+        cv_mutex_unlock(&bt.mutex);
+
+        for (;;) {
+            cv_mutex_lock(&bt.mutex);
+            bool is_everyone_woken = bt.woken == BROADCAST_WAITERS * round;
+            cv_mutex_unlock(&bt.mutex);
+
+            if (is_everyone_woken) {
+                break;
+            }
+            sched_yield();
+        }
+
+        context_switches += get_context_switches() - context_switches_before;
+    }
+
+    for (int i = 0; i < BROADCAST_WAITERS; ++i) {
+        pthread_join(thread_ids[i], NULL);
+    }
+
+    printf("%-8s broadcast, %d waiters: wake-to-lock avg %8.2f us, max %8.2f us, %6.1f context switches/round\n",
+           use_requeue ? "requeue" : "wake-all", BROADCAST_WAITERS,
+           bt.total_latency / bt.woken * 1e6, bt.max_latency * 1e6,
+           (double) context_switches / BROADCAST_ROUNDS);
+
+    cond_destroy(bt.cv);
+
+    if (bt.woken != BROADCAST_WAITERS * BROADCAST_ROUNDS) {
+        printf("bench_broadcast: Failure. Woken = %d\n", bt.woken);
+        return 1;
+    }
+
+    return 0;
+}
+
+#define EVENTCOUNT_ITEMS 200000
+#define NOTIFY_ITERATIONS 10000000
+
+typedef struct {
+    _Atomic int items;
+    eventcount_t ec;
+} eventcount_test_t;
+
+static bool try_take_item(eventcount_test_t *et) {
+
+    int items = atomic_load_explicit(&et->items, memory_order_relaxed);
+
+    while (items > 0) {
+        if (atomic_compare_exchange_weak(&et->items, &items, items - 1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void *eventcount_consumer(void *data) {
+
+    eventcount_test_t *et = (eventcount_test_t*) data;
+
+    for (int taken = 0; taken < EVENTCOUNT_ITEMS; ++taken) {
+
+        while (!try_take_item(et)) {
+
+            uint32_t key = eventcount_prepare_wait(&et->ec);
+
+            if (try_take_item(et)) {
+                eventcount_cancel_wait(&et->ec);
+                break;
+            }
+
+            eventcount_commit_wait(&et->ec, key);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Consumer sleeps on empty lock-free counter until producer adds items
+ */
+int test_eventcount() {
+
+    eventcount_test_t et;
+    atomic_init(&et.items, 0);
+    eventcount_init(&et.ec);
+
+    pthread_t consumer_thread;
+    pthread_create(&consumer_thread, NULL, eventcount_consumer, &et);
+
+    for (int i = 0; i < EVENTCOUNT_ITEMS; ++i) {
+        atomic_fetch_add(&et.items, 1);
+        eventcount_notify(&et.ec);
+    }
+
+    pthread_join(consumer_thread, NULL);
+
+    if (atomic_load(&et.items) != 0 || atomic_load(&et.ec.waiters) != 0) {
+        printf("test_eventcount: Failure\n");
+        return 1;
+    }
+
+    printf("test_eventcount: Success\n");
+
+    return 0;
+}
+
+/*
+ * Producer side cost, when nobody is waiting
+ */
+void bench_idle_notify() {
+
+    struct timespec start, end;
+
+    eventcount_t ec;
+    eventcount_init(&ec);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < NOTIFY_ITERATIONS; ++i) {
+        eventcount_notify(&ec);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("eventcount_notify:           %6.2f ns\n", get_time_diff_sec(&start, &end) / NOTIFY_ITERATIONS * 1e9);
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cv, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < NOTIFY_ITERATIONS; ++i) {
+        pthread_mutex_lock(&mutex);
+        pthread_cond_signal(&cv);
+        pthread_mutex_unlock(&mutex);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("pthread lock/signal/unlock:  %6.2f ns\n", get_time_diff_sec(&start, &end) / NOTIFY_ITERATIONS * 1e9);
+
+    pthread_cond_destroy(&cv);
+    pthread_mutex_destroy(&mutex);
+}
+
+int main() {
+
+    int result = test_timed_wait();
+
+    result |= test_eventcount();
+    bench_idle_notify();
+
+    result |= bench_broadcast(true);
+    result |= bench_broadcast(false);
+
+    bench_ping_pong(false);
+    bench_ping_pong(true);
+
+    return result;
+}
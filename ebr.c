@@ -0,0 +1,255 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_EBR_
+#define ST_EBR_
+#include "ebr.h"
+#endif
+
+
+/**
+ * @function inits reclamation domain
+ * @returns  pointer to the created domain or NULL if error
+ */
+EBR_domain_t *init_EBR_domain() {
+
+  EBR_domain_t *domain = (EBR_domain_t*) aligned_alloc(EBR_CACHE_LINE_SIZE, sizeof(EBR_domain_t));
+
+  if (!domain) {
+    return NULL;
+  }
+
+  atomic_init(&domain->global_epoch, 0);
+  atomic_init(&domain->threads, NULL);
+
+  return domain;
+}
+
+
+/**
+ * @function frees all retired nodes of the bag
+ * @returns  number of freed nodes
+ */
+static int free_EBR_bag_items(EBR_bag_t *bag) {
+
+  int freed_counter = bag->size;
+
+  for (unsigned int i = 0; i < bag->size; ++i) {
+    (*(bag->items[i].free_func))(bag->items[i].ptr);
+  }
+
+  bag->size = 0;
+
+  return freed_counter;
+}
+
+
+/**
+ * @function frees domain, all thread records and all retired nodes
+ * @alert    no thread may be inside critical section or use the domain
+ */
+void close_EBR_domain(EBR_domain_t *domain) {
+
+  EBR_thread_t *thread = atomic_load(&domain->threads);
+
+  while (thread) {
+
+    EBR_thread_t *next_thread = thread->next;
+
+    for (int i = 0; i < EBR_NUMBER_OF_EPOCHS; ++i) {
+      free_EBR_bag_items(&thread->bags[i]);
+      free(thread->bags[i].items);
+    }
+
+    free(thread);
+    thread = next_thread;
+  }
+
+  free(domain);
+}
+
+
+/**
+ * @function registers calling thread in domain
+ * @brief    Record of unregistered thread is reused together
+ *           with nodes, that it has not reclaimed yet
+ * @returns  thread record or NULL if error
+ */
+EBR_thread_t *EBR_register_thread(EBR_domain_t *domain) {
+
+  for (EBR_thread_t *thread = atomic_load(&domain->threads); thread; thread = thread->next) {
+
+    bool expected_in_use = false;
+
+    if (atomic_compare_exchange_strong(&thread->is_in_use, &expected_in_use, true)) {
+      return thread;
+    }
+  }
+
+  EBR_thread_t *thread = (EBR_thread_t*) aligned_alloc(EBR_CACHE_LINE_SIZE, sizeof(EBR_thread_t));
+
+  if (!thread) {
+    return NULL;
+  }
+
+  atomic_init(&thread->local_epoch, 0);
+  thread->nesting = 0;
+  thread->retired_since_collect = 0;
+
+  for (int i = 0; i < EBR_NUMBER_OF_EPOCHS; ++i) {
+    thread->bags[i].epoch = 0;
+    thread->bags[i].size = 0;
+    thread->bags[i].capacity = 0;
+    thread->bags[i].items = NULL;
+  }
+
+  thread->domain = domain;
+  atomic_init(&thread->is_in_use, true);
+
+  thread->next = atomic_load_explicit(&domain->threads, memory_order_relaxed);
+
+  while (!atomic_compare_exchange_weak_explicit(&domain->threads, &thread->next, thread,
+                                                memory_order_release, memory_order_relaxed));
+
+  return thread;
+}
+
+
+/**
+ * @function unregisters thread, record becomes available for reuse
+ * @alert    should be called outside of critical section
+ */
+void EBR_unregister_thread(EBR_thread_t *thread) {
+
+  EBR_collect(thread);
+
+  atomic_store_explicit(&thread->local_epoch, 0, memory_order_release);
+  atomic_store_explicit(&thread->is_in_use, false, memory_order_release);
+}
+
+
+/**
+ * @function tries to advance global epoch
+ * @brief    Epoch advances only if every thread inside critical
+ *           section has already observed the current one
+ * @returns  current global epoch
+ */
+static unsigned long EBR_try_advance(EBR_domain_t *domain) {
+
+  unsigned long epoch = atomic_load(&domain->global_epoch);
+
+  for (EBR_thread_t *thread = atomic_load(&domain->threads); thread; thread = thread->next) {
+
+    unsigned long local_epoch = atomic_load(&thread->local_epoch);
+
+    if ((local_epoch & 1) && (local_epoch >> 1) != epoch) {
+      return epoch;
+    }
+  }
+
+  // fails only if other thread has advanced it already
+  atomic_compare_exchange_strong(&domain->global_epoch, &epoch, epoch + 1);
+
+  return atomic_load(&domain->global_epoch);
+}
+
+
+/**
+ * @function frees nodes of the calling thread, that no reader can see
+ * @returns  number of freed nodes
+ */
+int EBR_collect(EBR_thread_t *thread) {
+
+  int freed_counter = 0;
+  unsigned long epoch = EBR_try_advance(thread->domain);
+
+  for (int i = 0; i < EBR_NUMBER_OF_EPOCHS; ++i) {
+
+    EBR_bag_t *bag = &thread->bags[i];
+
+    if (bag->size && bag->epoch + 2 <= epoch) {
+      freed_counter += free_EBR_bag_items(bag);
+    }
+  }
+
+  thread->retired_since_collect = 0;
+
+  return freed_counter;
+}
+
+
+/**
+ * @function defers freeing of unlinked node until no reader can see it
+ * @brief    Reclamation is amortized: each EBR_RECLAIM_THRESHOLD
+ *           retired nodes trigger a collection
+ * @returns  0 on success, -1 if error (node is not retired)
+ */
+int EBR_retire(EBR_thread_t *thread, void *ptr, EBR_free_func_t free_func) {
+
+  // node was unlinked before this load, so its epoch is not underestimated
+  atomic_thread_fence(memory_order_seq_cst);
+  unsigned long epoch = atomic_load(&thread->domain->global_epoch);
+
+  EBR_bag_t *bag = &thread->bags[epoch % EBR_NUMBER_OF_EPOCHS];
+
+  // bag holds nodes retired at least EBR_NUMBER_OF_EPOCHS epochs ago
+  if (bag->epoch != epoch) {
+    free_EBR_bag_items(bag);
+    bag->epoch = epoch;
+  }
+
+  if (bag->size == bag->capacity) {
+
+    unsigned int new_capacity = bag->capacity ? bag->capacity * 2 : EBR_RECLAIM_THRESHOLD;
+    EBR_retired_t *new_items = (EBR_retired_t*) realloc(bag->items, sizeof(EBR_retired_t) * new_capacity);
+
+    if (!new_items) {
+      return -1;
+    }
+
+    bag->items = new_items;
+    bag->capacity = new_capacity;
+  }
+
+  bag->items[bag->size].ptr = ptr;
+  bag->items[bag->size].free_func = free_func;
+  bag->size++;
+
+  if (++thread->retired_since_collect >= EBR_RECLAIM_THRESHOLD) {
+    EBR_collect(thread);
+  }
+
+  return 0;
+}
+
+
+static void free_retired_list_item_data(void *item_data) {
+  free_list_item_data((list_item_data_t*) item_data);
+}
+
+
+static void free_retired_list_item(void *item) {
+  free_list_item((list_item_t*) item);
+}
+
+
+/**
+ * @function retires list's item data
+ * @brief    Data is released by its free_func_ptr callback on reclamation
+ */
+int EBR_retire_list_item_data(EBR_thread_t *thread, list_item_data_t *item_data) {
+  return EBR_retire(thread, item_data, free_retired_list_item_data);
+}
+
+
+/**
+ * @function retires unlinked list's item together with its data
+ */
+int EBR_retire_list_item(EBR_thread_t *thread, list_item_t *item) {
+  return EBR_retire(thread, item, free_retired_list_item);
+}
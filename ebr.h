@@ -0,0 +1,144 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+
+
+/*
+ * Epoch-based memory reclamation
+ *
+ * Readers wrap every access to shared nodes into EBR_enter/EBR_exit.
+ * Writers, that unlinked a node, pass it to EBR_retire instead of
+ * freeing it. Node retired in epoch E is freed once global epoch
+ * reaches E + 2: by then every thread, that could still see the node,
+ * has left its critical section.
+ *
+ * Global epoch advances only when all active threads have observed it,
+ * so a thread stuck inside critical section delays reclamation
+ * (memory grows), but never makes it unsafe.
+ */
+#define EBR_NUMBER_OF_EPOCHS 3
+#define EBR_RECLAIM_THRESHOLD 64
+#define EBR_CACHE_LINE_SIZE 64
+
+
+typedef void (*EBR_free_func_t)(void*);
+
+
+/**
+ * @struct retired node waiting for reclamation
+ */
+typedef struct {
+  void *ptr;
+  EBR_free_func_t free_func;
+} EBR_retired_t;
+
+
+/**
+ * @struct growable array of nodes retired in the same epoch
+ */
+typedef struct {
+  unsigned long epoch;
+  unsigned int size;
+  unsigned int capacity;
+  EBR_retired_t *items;
+} EBR_bag_t;
+
+
+struct EBR_domain_t_;
+
+
+/**
+ * @struct per-thread reclamation state
+ *
+ * @prop {local_epoch} observed epoch shifted left by one, lowest bit
+ *                     is set while thread is inside critical section
+ */
+typedef struct EBR_thread_t_ {
+
+  _Alignas(EBR_CACHE_LINE_SIZE) _Atomic unsigned long local_epoch;
+
+  // Fields below are touched only by owning thread
+  unsigned int nesting;
+  unsigned int retired_since_collect;
+  EBR_bag_t bags[EBR_NUMBER_OF_EPOCHS];
+
+  struct EBR_domain_t_ *domain;
+
+  // Record is reused after thread unregisters
+  atomic_bool is_in_use;
+  struct EBR_thread_t_ *next;
+
+} EBR_thread_t;
+
+
+/**
+ * @struct reclamation domain shared by one or more data structures
+ */
+typedef struct EBR_domain_t_ {
+
+  _Alignas(EBR_CACHE_LINE_SIZE) _Atomic unsigned long global_epoch;
+
+  // Registered thread records, list only grows
+  _Atomic(EBR_thread_t*) threads;
+
+} EBR_domain_t;
+
+
+EBR_domain_t *init_EBR_domain();
+
+
+void close_EBR_domain(EBR_domain_t *domain);
+
+
+EBR_thread_t *EBR_register_thread(EBR_domain_t *domain);
+
+
+void EBR_unregister_thread(EBR_thread_t *thread);
+
+
+int EBR_retire(EBR_thread_t *thread, void *ptr, EBR_free_func_t free_func);
+
+
+/**
+ * @alert Retired data is freed alone, item, that held it, stays valid.
+ *        Item should point to other data before its old data is retired,
+ *        because free_list_item frees item's current data (see list.h)
+ */
+int EBR_retire_list_item_data(EBR_thread_t *thread, list_item_data_t *item_data);
+
+
+int EBR_retire_list_item(EBR_thread_t *thread, list_item_t *item);
+
+
+int EBR_collect(EBR_thread_t *thread);
+
+
+/**
+ * @function enters critical section, nested calls are allowed
+ * @brief    After it returns, nodes reachable from shared pointers
+ *           stay valid until matching EBR_exit
+ */
+static inline void EBR_enter(EBR_thread_t *thread) {
+
+  if (thread->nesting++) {
+    return;
+  }
+
+  unsigned long epoch = atomic_load_explicit(&thread->domain->global_epoch, memory_order_relaxed);
+  atomic_store_explicit(&thread->local_epoch, (epoch << 1) | 1, memory_order_relaxed);
+
+  // announcement must be visible before any shared pointer is read
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+
+/**
+ * @function exits critical section
+ */
+static inline void EBR_exit(EBR_thread_t *thread) {
+
+  if (--thread->nesting) {
+    return;
+  }
+
+  atomic_store_explicit(&thread->local_epoch, 0, memory_order_release);
+}
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_EBR_
+#define ST_EBR_
+#include "ebr.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int NUMBER_OF_READERS = 8;
+const int NUMBER_OF_UPDATES = 200000;
+const int ENTER_EXIT_ITERATIONS = 10000000;
+const int VALID_DATA_VALUE = 42;
+
+
+typedef struct {
+  EBR_domain_t *domain;
+  _Atomic(list_item_data_t*) *shared;
+  atomic_bool *is_running;
+  long reads;
+  int errors;
+} reader_input_t;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+// poisons value, so reader can see use after reclamation
+static void free_checked_int(void *data) {
+  *((int*) data) = -1;
+  free(data);
+}
+
+
+static list_item_data_t *init_checked_item_data() {
+  int *data = (int*) malloc(sizeof(int));
+  *data = VALID_DATA_VALUE;
+  return init_list_item_data(data, free_checked_int);
+}
+
+
+void *reader_worker(void *_input) {
+
+  reader_input_t *input = (reader_input_t*) _input;
+  EBR_thread_t *thread = EBR_register_thread(input->domain);
+
+  while (atomic_load_explicit(input->is_running, memory_order_relaxed)) {
+
+    EBR_enter(thread);
+
+    list_item_data_t *item_data = atomic_load_explicit(input->shared, memory_order_acquire);
+    if (*((int*) item_data->data_ptr) != VALID_DATA_VALUE) {
+      ++input->errors;
+    }
+
+    EBR_exit(thread);
+    ++input->reads;
+  }
+
+  EBR_unregister_thread(thread);
+
+  return NULL;
+}
+
+
+/**
+ * @function readers dereference shared item data, while writer replaces and retires it
+ * @returns  0 if no reader has seen reclaimed data
+ */
+int test_retire_under_readers() {
+
+  EBR_domain_t *domain = init_EBR_domain();
+  _Atomic(list_item_data_t*) shared = init_checked_item_data();
+  atomic_bool is_running = true;
+
+  pthread_t thread_ids[NUMBER_OF_READERS];
+  reader_input_t inputs[NUMBER_OF_READERS];
+
+  for (int i = 0; i < NUMBER_OF_READERS; ++i) {
+    inputs[i] = (reader_input_t) { domain, &shared, &is_running, 0, 0 };
+    pthread_create(thread_ids + i, NULL, reader_worker, inputs + i);
+  }
+
+  EBR_thread_t *writer = EBR_register_thread(domain);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < NUMBER_OF_UPDATES; ++i) {
+    list_item_data_t *old_item_data = atomic_exchange(&shared, init_checked_item_data());
+    EBR_retire_list_item_data(writer, old_item_data);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  atomic_store(&is_running, false);
+
+  long reads = 0;
+  int errors = 0;
+
+  for (int i = 0; i < NUMBER_OF_READERS; ++i) {
+    pthread_join(thread_ids[i], NULL);
+    reads += inputs[i].reads;
+    errors += inputs[i].errors;
+  }
+
+  printf("retire: %6.2f ns/update with %d readers (%ld reads)\n",
+         get_time_diff_sec(&start, &end) / NUMBER_OF_UPDATES * 1e9, NUMBER_OF_READERS, reads);
+
+  EBR_unregister_thread(writer);
+  free_list_item_data(atomic_load(&shared));
+  close_EBR_domain(domain);
+
+  if (errors) {
+    printf("test_retire_under_readers: Failure. Errors = %d\n", errors);
+    return 1;
+  }
+
+  printf("test_retire_under_readers: Success\n");
+
+  return 0;
+}
+
+
+/**
+ * @function retires data of linked items and checks, that items survive reclamation
+ * @returns  0 if list is intact after data is freed and cells are reused
+ */
+int test_retire_data_of_linked_item() {
+
+  EBR_domain_t *domain = init_EBR_domain();
+  EBR_thread_t *thread = EBR_register_thread(domain);
+  list_t *list = init_list();
+
+  for (int i = 0; i < NUMBER_OF_READERS; ++i) {
+    add_item_to_tail_of_list(list, init_checked_item_data());
+  }
+
+  // items get new data, old one is retired while items stay linked
+  for (list_item_t *item = list->head->next; item != list->tail; item = item->next) {
+    list_item_data_t *old_item_data = item->data;
+    item->data = init_checked_item_data();
+    EBR_retire_list_item_data(thread, old_item_data);
+  }
+
+  // frees retired data
+  EBR_unregister_thread(thread);
+  close_EBR_domain(domain);
+
+  // reuses freed cells
+  list_t *other_list = init_list();
+  for (int i = 0; i < NUMBER_OF_READERS; ++i) {
+    add_item_to_tail_of_list(other_list, init_checked_item_data());
+  }
+
+  int number_of_items = 0;
+  int errors = 0;
+
+  for (list_item_t *item = list->head->next; item != list->tail; item = item->next) {
+    ++number_of_items;
+    errors += *((int*) get_list_item_data(item)) != VALID_DATA_VALUE;
+  }
+
+  close_list(list);
+  close_list(other_list);
+
+  if (errors || number_of_items != NUMBER_OF_READERS) {
+    printf("test_retire_data_of_linked_item: Failure\n");
+    return 1;
+  }
+
+  printf("test_retire_data_of_linked_item: Success\n");
+
+  return 0;
+}
+
+/**
+ * @function measures cost of empty critical section
+ */
+void bench_enter_exit() {
+
+  EBR_domain_t *domain = init_EBR_domain();
+  EBR_thread_t *thread = EBR_register_thread(domain);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < ENTER_EXIT_ITERATIONS; ++i) {
+    EBR_enter(thread);
+    EBR_exit(thread);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("enter/exit: %6.2f ns\n", get_time_diff_sec(&start, &end) / ENTER_EXIT_ITERATIONS * 1e9);
+
+  EBR_unregister_thread(thread);
+  close_EBR_domain(domain);
+}
+
+
+int main() {
+
+  bench_enter_exit();
+
+  int result = 0;
+
+  result |= test_retire_under_readers();
+  result |= test_retire_data_of_linked_item();
+
+  return result;
+}
@@ -0,0 +1,94 @@
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+
+/*
+ * Thin wrappers over Linux futex syscall. All futexes here are
+ * process private. Functions return syscall result: -1 and errno
+ * on failure, EAGAIN from wait means value has already changed.
+ */
+
+
+typedef _Atomic uint32_t futex_word_t;
+
+
+/**
+ * @function sleeps while *word == expected
+ */
+static inline long futex_wait(futex_word_t *word, uint32_t expected) {
+    return syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+
+/**
+ * @function sleeps while *word == expected, but not past abstime
+ * @brief    abstime is absolute CLOCK_MONOTONIC time, NULL means no timeout.
+ *           Fails with ETIMEDOUT when time is out
+ */
+static inline long futex_wait_until(futex_word_t *word, uint32_t expected, const struct timespec *abstime) {
+    return syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, expected, abstime, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+
+/**
+ * @function wakes at most count threads sleeping on word
+ * @returns  number of woken threads
+ */
+static inline long futex_wake(futex_word_t *word, int count) {
+    return syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+
+/**
+ * @function hints CPU, that current thread is spinning
+ */
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    atomic_signal_fence(memory_order_seq_cst);
+#endif
+}
+
+
+/**
+ * @function one step of busy waiting loop
+ * @brief    Yields CPU every spin_limit steps, so spinning thread
+ *           does not starve the thread it waits for
+ */
+static inline void spin_wait_step(unsigned int *spin_counter, unsigned int spin_limit) {
+    if (++*spin_counter < spin_limit) {
+        cpu_relax();
+    } else {
+        *spin_counter = 0;
+        sched_yield();
+    }
+}
+
+
+// -1 - unknown yet, 0 - single CPU, 1 - several CPUs
+static _Atomic int has_several_cpus = -1;
+
+
+/**
+ * @function tells, whether busy waiting may pay off
+ * @brief    On single CPU the awaited thread can not run while
+ *           waiter spins, so waiter should sleep right away
+ */
+static inline bool should_spin() {
+
+    int result = atomic_load_explicit(&has_several_cpus, memory_order_relaxed);
+
+    if (result < 0) {
+        result = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+        atomic_store_explicit(&has_several_cpus, result, memory_order_relaxed);
+    }
+
+    return result;
+}
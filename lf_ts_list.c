@@ -0,0 +1,352 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_EBR_
+#define ST_EBR_
+#include "ebr.h"
+#endif
+
+#ifndef ST_LF_TS_LIST_
+#define ST_LF_TS_LIST_
+#include "lf_ts_list.h"
+#endif
+
+#define LF_REMOVED_MARK ((uintptr_t) 1)
+
+
+/*
+ * All lock-free lists share one reclamation domain. Thread registers
+ * in it on its first operation and leaves it, when it exits.
+ */
+static pthread_once_t lf_domain_once = PTHREAD_ONCE_INIT;
+static EBR_domain_t *lf_domain = NULL;
+static pthread_key_t lf_thread_exit_key;
+
+static _Thread_local EBR_thread_t *lf_thread = NULL;
+
+
+static void unregister_lf_thread(void *thread) {
+  EBR_unregister_thread((EBR_thread_t*) thread);
+}
+
+
+static void init_lf_domain() {
+  lf_domain = init_EBR_domain();
+  pthread_key_create(&lf_thread_exit_key, unregister_lf_thread);
+}
+
+
+/**
+ * @returns EBR record of calling thread or NULL if error
+ */
+static EBR_thread_t *get_lf_thread() {
+
+  if (lf_thread) {
+    return lf_thread;
+  }
+
+  pthread_once(&lf_domain_once, init_lf_domain);
+
+  if (!lf_domain) {
+    return NULL;
+  }
+
+  lf_thread = EBR_register_thread(lf_domain);
+
+  if (lf_thread) {
+    pthread_setspecific(lf_thread_exit_key, lf_thread);
+  }
+
+  return lf_thread;
+}
+
+
+static inline lf_list_item_t *get_lf_item(uintptr_t link) {
+  return (lf_list_item_t*) (link & ~LF_REMOVED_MARK);
+}
+
+
+static inline int is_lf_item_removed(uintptr_t link) {
+  return (link & LF_REMOVED_MARK) != 0;
+}
+
+
+static lf_list_item_t *init_lf_list_item(list_item_data_t *item_data) {
+
+  lf_list_item_t *item = (lf_list_item_t*) malloc(sizeof(lf_list_item_t));
+
+  if (!item) {
+    return NULL;
+  }
+
+  atomic_init(&item->data, item_data);
+  atomic_init(&item->next, 0);
+
+  return item;
+}
+
+
+static void free_lf_list_item(void *_item) {
+
+  lf_list_item_t *item = (lf_list_item_t*) _item;
+  list_item_data_t *item_data = atomic_load_explicit(&item->data, memory_order_relaxed);
+
+  if (item_data) {
+    free_list_item_data(item_data);
+  }
+
+  free(item);
+}
+
+
+lf_ts_list_t *init_lf_ts_list() {
+
+  if (!get_lf_thread()) {
+    return NULL;
+  }
+
+  lf_ts_list_t *list = (lf_ts_list_t*) aligned_alloc(64, sizeof(lf_ts_list_t));
+
+  if (!list) {
+    return NULL;
+  }
+
+  lf_list_item_t *sentinel = init_lf_list_item(NULL);
+
+  if (!sentinel) {
+    free(list);
+    return NULL;
+  }
+
+  atomic_init(&list->head.data, NULL);
+  atomic_init(&list->head.next, (uintptr_t) sentinel);
+  atomic_init(&list->tail, sentinel);
+
+  return list;
+}
+
+
+/**
+ * @function frees all items and list itself
+ * @alert    nobody may use the list
+ */
+void LF_close_list(lf_ts_list_t *list) {
+
+  lf_list_item_t *item = get_lf_item(atomic_load(&list->head.next));
+
+  while (item) {
+    lf_list_item_t *next_item = get_lf_item(atomic_load(&item->next));
+    free_lf_list_item(item);
+    item = next_item;
+  }
+
+  free(list);
+}
+
+
+lf_list_item_t *LF_add_item_to_head_of_list(lf_ts_list_t *list, list_item_data_t *item_data) {
+
+  lf_list_item_t *item = init_lf_list_item(item_data);
+
+  if (!item) {
+    return NULL;
+  }
+
+  // head is never removed, so its link is never marked
+  uintptr_t first_link = atomic_load(&list->head.next);
+
+  do {
+    atomic_store_explicit(&item->next, first_link, memory_order_relaxed);
+  } while (!atomic_compare_exchange_weak(&list->head.next, &first_link, (uintptr_t) item));
+
+  return item;
+}
+
+
+/**
+ * @function links new sentinel after the current one, that becomes the added item
+ * @returns  added item or NULL if error
+ */
+lf_list_item_t *LF_add_item_to_tail_of_list(lf_ts_list_t *list, list_item_data_t *item_data) {
+
+  EBR_thread_t *thread = get_lf_thread();
+  lf_list_item_t *new_sentinel = init_lf_list_item(NULL);
+
+  if (!thread || !new_sentinel) {
+    free(new_sentinel);
+    return NULL;
+  }
+
+  EBR_enter(thread);
+
+  lf_list_item_t *sentinel;
+
+  while (true) {
+
+    sentinel = atomic_load(&list->tail);
+    uintptr_t next_link = 0;
+
+    if (atomic_compare_exchange_strong(&sentinel->next, &next_link, (uintptr_t) new_sentinel)) {
+      break;
+    }
+
+    // other appender has linked its sentinel, help it to move tail
+    atomic_compare_exchange_strong(&list->tail, &sentinel, get_lf_item(next_link));
+  }
+
+  // item is not seen by readers until data is set
+  atomic_store_explicit(&sentinel->data, item_data, memory_order_release);
+
+  // fails if other appender has helped already
+  lf_list_item_t *expected_tail = sentinel;
+  atomic_compare_exchange_strong(&list->tail, &expected_tail, new_sentinel);
+
+  EBR_exit(thread);
+
+  return sentinel;
+}
+
+
+/**
+ * @function retires unlinked item
+ * @brief    Tail may lag one item behind sentinel. It is moved past
+ *           unlinked item first, so helping appender can not bring
+ *           the item back through stale link
+ */
+static void retire_lf_item(lf_ts_list_t *list, EBR_thread_t *thread, lf_list_item_t *item) {
+
+  while (true) {
+
+    lf_list_item_t *tail = atomic_load(&list->tail);
+    lf_list_item_t *next_item = get_lf_item(atomic_load(&tail->next));
+
+    if (tail != item && next_item != item) {
+      break;
+    }
+
+    atomic_compare_exchange_strong(&list->tail, &tail, next_item);
+  }
+
+  EBR_retire(thread, item, free_lf_list_item);
+}
+
+
+/**
+ * @function walks from head and unlinks removed items on its way
+ *           until searched item is unlinked by this or other thread
+ * @alert    should be called inside critical section
+ */
+static void unlink_removed_lf_items(lf_ts_list_t *list, EBR_thread_t *thread, lf_list_item_t *searched_item) {
+
+retry:
+  {
+    lf_list_item_t *prev_item = &list->head;
+    uintptr_t current_link = atomic_load(&prev_item->next);
+
+    while (true) {
+
+      lf_list_item_t *current_item = get_lf_item(current_link);
+
+      // sentinel is reached, so other thread has unlinked searched item
+      if (!current_item) {
+        return;
+      }
+
+      uintptr_t next_link = atomic_load(&current_item->next);
+
+      if (!is_lf_item_removed(next_link)) {
+        prev_item = current_item;
+        current_link = next_link;
+        continue;
+      }
+
+      // fails, if prev_item is removed too or has got new next item
+      uintptr_t expected_link = (uintptr_t) current_item;
+      uintptr_t unmarked_next_link = next_link & ~LF_REMOVED_MARK;
+
+      if (!atomic_compare_exchange_strong(&prev_item->next, &expected_link, unmarked_next_link)) {
+        goto retry;
+      }
+
+      retire_lf_item(list, thread, current_item);
+
+      if (current_item == searched_item) {
+        return;
+      }
+
+      current_link = unmarked_next_link;
+    }
+  }
+}
+
+
+/**
+ * @function marks item removed and unlinks it
+ * @alert    item may be removed only once, handle is invalid after that
+ * @returns  0 on success, -1 if error
+ */
+int LF_remove_item_from_list(lf_ts_list_t *list, lf_list_item_t *searched_item) {
+
+  EBR_thread_t *thread = get_lf_thread();
+
+  if (!thread || !searched_item) {
+    return -1;
+  }
+
+  EBR_enter(thread);
+
+  uintptr_t next_link = atomic_load(&searched_item->next);
+
+  do {
+    if (is_lf_item_removed(next_link)) {
+      EBR_exit(thread);
+      return -1;
+    }
+  } while (!atomic_compare_exchange_weak(&searched_item->next, &next_link, next_link | LF_REMOVED_MARK));
+
+  unlink_removed_lf_items(list, thread, searched_item);
+
+  EBR_exit(thread);
+
+  return 0;
+}
+
+
+/**
+ * @returns number of items, that are neither removed nor being added
+ */
+size_t LF_get_list_length(lf_ts_list_t *list) {
+
+  EBR_thread_t *thread = get_lf_thread();
+
+  if (!thread) {
+    return 0;
+  }
+
+  size_t length = 0;
+
+  EBR_enter(thread);
+
+  lf_list_item_t *item = get_lf_item(atomic_load(&list->head.next));
+
+  while (item) {
+
+    uintptr_t next_link = atomic_load(&item->next);
+
+    if (!is_lf_item_removed(next_link) && atomic_load_explicit(&item->data, memory_order_acquire)) {
+      ++length;
+    }
+
+    item = get_lf_item(next_link);
+  }
+
+  EBR_exit(thread);
+
+  return length;
+}
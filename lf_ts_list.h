@@ -0,0 +1,78 @@
+#include <stdatomic.h>
+#include <stdint.h>
+
+
+/*
+ * Lock-free thread safe list
+ *
+ * Harris-style singly linked list with the API of ts_list.h. Item is
+ * removed in two steps: its next pointer is marked first (logical
+ * deletion), then the item is unlinked from its predecessor by remover
+ * or by any thread, that passes it. Unlinked items are reclaimed with
+ * EBR, so they stay readable for threads that still hold them.
+ *
+ * Last item is always an empty tail sentinel. Appender links a new
+ * sentinel after it and puts its data into the old one, so adding to
+ * tail is O(1) as adding to head. Removal walks from head to find
+ * predecessor, so it is O(n).
+ *
+ * Item handle, that add returns, may be removed at most once and is
+ * invalid after that: its memory is reclaimed, as soon as no thread
+ * can reach it, so it must not be passed to remove again.
+ *
+ * Needs list.h included before. Build with -DTS_LIST_LOCK_FREE to
+ * get TS_ names mapped to this list instead of ts_list.c, item
+ * handles are lf_list_item_t* then.
+ */
+
+
+/**
+ * @struct Item of lock-free list
+ *
+ * @prop {data} item data, NULL for tail sentinel
+ * @prop {next} pointer to next item, lowest bit is set, when item is removed
+ */
+typedef struct lf_list_item_t_ {
+  _Atomic(list_item_data_t*) data;
+  _Atomic uintptr_t next;
+} lf_list_item_t;
+
+
+/**
+ * @struct Lock-free list
+ *
+ * @prop {head} dummy item before first one, never removed
+ * @prop {tail} tail sentinel or item just before it, while append is in progress
+ */
+typedef struct {
+  _Alignas(64) lf_list_item_t head;
+  _Alignas(64) _Atomic(lf_list_item_t*) tail;
+} lf_ts_list_t;
+
+
+lf_ts_list_t *init_lf_ts_list();
+
+
+void LF_close_list(lf_ts_list_t *list);
+
+
+lf_list_item_t *LF_add_item_to_head_of_list(lf_ts_list_t *list, list_item_data_t *item_data);
+
+
+lf_list_item_t *LF_add_item_to_tail_of_list(lf_ts_list_t *list, list_item_data_t *item_data);
+
+
+int LF_remove_item_from_list(lf_ts_list_t *list, lf_list_item_t *searched_item);
+
+
+size_t LF_get_list_length(lf_ts_list_t *list);
+
+
+#ifdef TS_LIST_LOCK_FREE
+#define ts_list_t lf_ts_list_t
+#define init_ts_list init_lf_ts_list
+#define TS_close_list LF_close_list
+#define TS_add_item_to_head_of_list LF_add_item_to_head_of_list
+#define TS_add_item_to_tail_of_list LF_add_item_to_tail_of_list
+#define TS_remove_item_from_list LF_remove_item_from_list
+#endif
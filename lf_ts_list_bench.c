@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_ADAPTIVE_MUTEX_
+#define ST_ADAPTIVE_MUTEX_
+#include "adaptive_mutex.h"
+#endif
+
+// with TS_LIST_LOCK_FREE TS_ names are mapped to lock-free list
+#ifndef TS_LIST_LOCK_FREE
+#ifndef ST_TS_LIST_
+#define ST_TS_LIST_
+#include "ts_list.h"
+#endif
+#endif
+
+#ifndef ST_LF_TS_LIST_
+#define ST_LF_TS_LIST_
+#include "lf_ts_list.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+#define MAX_NUMBER_OF_THREADS 16
+#define ITEMS_PER_THREAD 8
+
+const int OPERATIONS_PER_THREAD = 200000;
+
+
+typedef struct {
+  ts_list_t *ts_list;
+  lf_ts_list_t *lf_ts_list;
+  int thread_index;
+  long number_of_failures;
+} list_worker_input_t;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void do_nothing(void *data) {
+  (void) data;
+}
+
+
+/**
+ * @function keeps ITEMS_PER_THREAD own items in list, adding new one to
+ *           head or tail and removing the oldest one every operation
+ */
+static void *list_worker(void *data) {
+
+  list_worker_input_t *input = (list_worker_input_t*) data;
+  void *items[ITEMS_PER_THREAD] = { NULL };
+
+  for (long i = 0; i < OPERATIONS_PER_THREAD + ITEMS_PER_THREAD; ++i) {
+
+    void **slot = items + i % ITEMS_PER_THREAD;
+
+    if (*slot) {
+      // handles are passed as void*, as TS_ names may take either item type
+      int result = input->ts_list ? TS_remove_item_from_list(input->ts_list, *slot)
+                                  : LF_remove_item_from_list(input->lf_ts_list, *slot);
+      input->number_of_failures += result != 0;
+      *slot = NULL;
+    }
+
+    if (i >= OPERATIONS_PER_THREAD) {
+      continue;
+    }
+
+    list_item_data_t *item_data = init_list_item_data((void*) i, do_nothing);
+    int add_to_head = (i + input->thread_index) % 2;
+
+    if (input->ts_list) {
+      *slot = add_to_head ? TS_add_item_to_head_of_list(input->ts_list, item_data)
+                          : TS_add_item_to_tail_of_list(input->ts_list, item_data);
+    } else {
+      *slot = add_to_head ? LF_add_item_to_head_of_list(input->lf_ts_list, item_data)
+                          : LF_add_item_to_tail_of_list(input->lf_ts_list, item_data);
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @returns 0 if all removes succeeded and list is empty in the end
+ */
+int bench_list(int is_lock_free, int number_of_threads) {
+
+  ts_list_t *ts_list = is_lock_free ? NULL : init_ts_list();
+  lf_ts_list_t *lf_ts_list = is_lock_free ? init_lf_ts_list() : NULL;
+
+  pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+  list_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    inputs[i] = (list_worker_input_t) { ts_list, lf_ts_list, i, 0 };
+    pthread_create(thread_ids + i, NULL, list_worker, inputs + i);
+  }
+
+  long number_of_failures = 0;
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    pthread_join(thread_ids[i], NULL);
+    number_of_failures += inputs[i].number_of_failures;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  int is_empty;
+
+  if (is_lock_free) {
+    is_empty = LF_get_list_length(lf_ts_list) == 0;
+    LF_close_list(lf_ts_list);
+  } else {
+#ifdef TS_LIST_LOCK_FREE
+    // not reached, mutex leg is skipped, when TS_ names are mapped
+    is_empty = LF_get_list_length(ts_list) == 0;
+#else
+    is_empty = is_list_empty(ts_list->origin_list);
+#endif
+    TS_close_list(ts_list);
+  }
+
+  double operations = 2.0 * OPERATIONS_PER_THREAD * number_of_threads;
+
+  printf("%-12s threads=%2d: %8.2f Mops/s\n", is_lock_free ? "lf_ts_list_t" : "ts_list_t",
+         number_of_threads, operations / get_time_diff_sec(&start, &end) * 1e-6);
+
+  return !number_of_failures && is_empty ? 0 : 1;
+}
+
+
+
+// ------------------------------------------------------
+// ------------------------ Tests -----------------------
+// ------------------------------------------------------
+
+#ifdef TS_LIST_LOCK_FREE
+
+/**
+ * @function runs list workers through TS_ names, that are mapped to lock-free list
+ * @returns  0 if all removes succeeded and list is empty in the end
+ */
+int test_mapped_ts_names() {
+
+  ts_list_t *ts_list = init_ts_list();
+
+  pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+  list_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+  for (int i = 0; i < MAX_NUMBER_OF_THREADS; ++i) {
+    inputs[i] = (list_worker_input_t) { ts_list, NULL, i, 0 };
+    pthread_create(thread_ids + i, NULL, list_worker, inputs + i);
+  }
+
+  long number_of_failures = 0;
+
+  for (int i = 0; i < MAX_NUMBER_OF_THREADS; ++i) {
+    pthread_join(thread_ids[i], NULL);
+    number_of_failures += inputs[i].number_of_failures;
+  }
+
+  int is_empty = LF_get_list_length(ts_list) == 0;
+  TS_close_list(ts_list);
+
+  if (number_of_failures || !is_empty) {
+    printf("test_mapped_ts_names: Failure\n");
+    return 1;
+  }
+
+  printf("test_mapped_ts_names: Success\n");
+
+  return 0;
+}
+
+#else
+
+const int FIFO_ITEMS = 100000;
+
+
+static void *test_fifo_producer(void *_list) {
+
+  ts_list_t *list = (ts_list_t*) _list;
+
+  // data starts from 1, NULL means empty list for consumer
+  for (long i = 1; i <= FIFO_ITEMS; ++i) {
+    TS_add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+  }
+
+  return NULL;
+}
+
+
+static void *test_fifo_consumer(void *_list) {
+
+  ts_list_t *list = (ts_list_t*) _list;
+  long expected = 1;
+
+  while (expected <= FIFO_ITEMS) {
+
+    long data = (long) TS_remove_and_get_item_from_head(list);
+
+    if (!data) {
+      sched_yield();
+      continue;
+    }
+
+    if (data != expected) {
+      return (void*) 1;
+    }
+
+    ++expected;
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @function removes from head while other thread adds to tail
+ * @brief    Removal from head of list with more than one item does not
+ *           take tail mutex, so it must not touch last_item
+ * @returns  0 if items came out in order and list is consistent
+ */
+int test_remove_head_while_adding_tail() {
+
+  ts_list_t *list = init_ts_list();
+  pthread_t producer_id, consumer_id;
+  void *consumer_result;
+
+  pthread_create(&producer_id, NULL, test_fifo_producer, list);
+  pthread_create(&consumer_id, NULL, test_fifo_consumer, list);
+
+  pthread_join(producer_id, NULL);
+  pthread_join(consumer_id, &consumer_result);
+
+  list_t *origin_list = list->origin_list;
+  int is_consistent = is_list_empty(origin_list) && !origin_list->last_item &&
+                      origin_list->tail->prev == origin_list->head;
+
+  TS_close_list(list);
+
+  if (consumer_result || !is_consistent) {
+    printf("test_remove_head_while_adding_tail: Failure\n");
+    return 1;
+  }
+
+  printf("test_remove_head_while_adding_tail: Success\n");
+
+  return 0;
+}
+
+#endif
+
+
+int main() {
+
+  int result = 0;
+
+#ifdef TS_LIST_LOCK_FREE
+  printf("TS_ names are mapped to lock-free list, ts_list_t baseline is skipped\n");
+  result |= test_mapped_ts_names();
+#else
+  result |= test_remove_head_while_adding_tail();
+#endif
+
+  for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+#ifndef TS_LIST_LOCK_FREE
+    result |= bench_list(0, n);
+#endif
+    result |= bench_list(1, n);
+  }
+
+  printf(result ? "Failure\n" : "Success\n");
+
+  return result;
+}
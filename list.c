@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 #include "list.h"
 
 #ifndef TS_LAMBDA_
@@ -8,16 +9,205 @@
 #define DO_NOTHING_FUNC LAMBDA(void _(void*_) {})
 #endif
 
+#ifndef LIST_NO_POOL
+
+/*
+ * Pool of list cells
+ *
+ * Cell holds either an item or an item's data. Item and its data
+ * take separate cells, so data may be freed while its item is linked,
+ * and every item has a cell of its own. Both are cut one after another
+ * from the same freelist, so they usually lie next to each other
+ * in a slab. Each thread takes cells from its own freelist, empty
+ * freelist is refilled by a batch of cells returned by other threads
+ * or by a new slab of contiguous cells. Thread, that has freed too
+ * many cells, hands a batch back. Slabs are never returned to system.
+ *
+ * Build with -DLIST_NO_POOL to allocate items and data with malloc.
+ */
+
+#define LIST_POOL_BATCH_SIZE 64
+
+/**
+ * @struct Cell of list item or of item data
+ *
+ * Free cells are chained through item.next, batches of free cells
+ * in global stack - through item.prev of their first cells
+ */
+typedef union {
+  list_item_t item;
+  list_item_data_t data;
+} list_cell_t;
+
+static pthread_mutex_t free_batches_mutex = PTHREAD_MUTEX_INITIALIZER;
+static list_cell_t *free_batches = NULL;
+
+static pthread_once_t thread_exit_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_exit_key;
+
+static _Thread_local list_cell_t *local_free_cells = NULL;
+static _Thread_local int number_of_local_free_cells = 0;
+static _Thread_local int is_local_pool_registered = 0;
+
+
+static void push_free_batch(list_cell_t *batch) {
+  pthread_mutex_lock(&free_batches_mutex);
+  batch->item.prev = free_batches ? &free_batches->item : NULL;
+  free_batches = batch;
+  pthread_mutex_unlock(&free_batches_mutex);
+}
+
+
+static list_cell_t *pop_free_batch() {
+
+  pthread_mutex_lock(&free_batches_mutex);
+
+  list_cell_t *batch = free_batches;
+  if (batch) {
+    free_batches = (list_cell_t*) batch->item.prev;
+  }
+
+  pthread_mutex_unlock(&free_batches_mutex);
+
+  return batch;
+}
+
+
+/**
+ * @function Gives free cells of exiting thread to others
+ */
+static void release_local_free_cells(void *unused) {
+
+  (void) unused;
+
+  if (local_free_cells) {
+    push_free_batch(local_free_cells);
+  }
+
+  local_free_cells = NULL;
+  number_of_local_free_cells = 0;
+}
+
+
+static void create_thread_exit_key() {
+  pthread_key_create(&thread_exit_key, release_local_free_cells);
+}
+
+
+/**
+ * @function Makes local cells of calling thread be released, when it exits
+ * @brief Called on first use of the local freelist, either by alloc or by free
+ */
+static inline void register_local_free_cells() {
+
+  if (is_local_pool_registered) {
+    return;
+  }
+
+  pthread_once(&thread_exit_key_once, create_thread_exit_key);
+  pthread_setspecific(thread_exit_key, (void*) 1);
+  is_local_pool_registered = 1;
+}
+
+
+/**
+ * @returns 0 on success, -1 if there is no memory
+ */
+static int refill_local_free_cells() {
+
+  register_local_free_cells();
+
+  list_cell_t *batch = pop_free_batch();
+
+  if (batch) {
+
+    local_free_cells = batch;
+    number_of_local_free_cells = 0;
+
+    for (list_item_t *item = &batch->item; item; item = item->next) {
+      ++number_of_local_free_cells;
+    }
+
+    return 0;
+  }
+
+  list_cell_t *slab = (list_cell_t*) malloc(sizeof(list_cell_t) * LIST_POOL_BATCH_SIZE);
+  if (!slab) {
+    return -1;
+  }
+
+  for (int i = 0; i < LIST_POOL_BATCH_SIZE; ++i) {
+    slab[i].item.next = i + 1 < LIST_POOL_BATCH_SIZE ? &slab[i + 1].item : NULL;
+  }
+
+  local_free_cells = slab;
+  number_of_local_free_cells = LIST_POOL_BATCH_SIZE;
+
+  return 0;
+}
+
+
+static list_cell_t *alloc_list_cell() {
+
+  if (!local_free_cells && refill_local_free_cells()) {
+    return NULL;
+  }
+
+  list_cell_t *cell = local_free_cells;
+  local_free_cells = (list_cell_t*) cell->item.next;
+  --number_of_local_free_cells;
+
+  return cell;
+}
+
+
+static void free_list_cell(list_cell_t *cell) {
+
+  // thread may only free cells, that were allocated by others
+  register_local_free_cells();
+
+  cell->item.next = local_free_cells ? &local_free_cells->item : NULL;
+  local_free_cells = cell;
+
+  if (++number_of_local_free_cells < 2 * LIST_POOL_BATCH_SIZE) {
+    return;
+  }
+
+  // cut batch of first cells off and give it to others
+  list_cell_t *last_cell = cell;
+  for (int i = 1; i < LIST_POOL_BATCH_SIZE; ++i) {
+    last_cell = (list_cell_t*) last_cell->item.next;
+  }
+
+  local_free_cells = (list_cell_t*) last_cell->item.next;
+  last_cell->item.next = NULL;
+  number_of_local_free_cells -= LIST_POOL_BATCH_SIZE;
+
+  push_free_batch(cell);
+}
+
+#endif
+
+
 /**
  * @function Initializes list's item data
  * @returns pointer to the created item data or NULL if error
  */
 list_item_data_t *init_list_item_data(void *data, void(*free_func)(void*)) {
 
+#ifndef LIST_NO_POOL
+  list_cell_t *cell = alloc_list_cell();
+  if (!cell) {
+    return NULL;
+  }
+
+  list_item_data_t *result = &cell->data;
+#else
   list_item_data_t *result = (list_item_data_t*) malloc(sizeof(list_item_data_t));
   if (!result) {
     return NULL;
   }
+#endif
 
   // default value
   if (!free_func) {
@@ -48,7 +238,11 @@ void free_list_item_data(list_item_data_t *lid) {
   }
 
   // free item's memory itsels
+#ifndef LIST_NO_POOL
+  free_list_cell(container_of(lid, list_cell_t, data));
+#else
   free(lid);
+#endif
 }
 
 
@@ -56,17 +250,58 @@ void free_list_item_data(list_item_data_t *lid) {
  * @function Initializes list's item
  * @returns pointer to the newly created list's item
  */
-list_item_t *init_list_item(list_item_data_t *data, list_item_t *next_item) {
+list_item_t *init_list_item(list_item_data_t *data, list_item_t *prev_item, list_item_t *next_item) {
+
+#ifndef LIST_NO_POOL
+  list_cell_t *cell = alloc_list_cell();
+  if (!cell) {
+    return NULL;
+  }
 
+  list_item_t *new_item = &cell->item;
+#else
   list_item_t *new_item = (list_item_t*) malloc(sizeof(list_item_t));
+  if (!new_item) {
+    return NULL;
+  }
+#endif
 
   new_item->data = data;
+  new_item->prev = prev_item;
   new_item->next = next_item;
 
   return new_item;
 }
 
 
+/**
+ * @function Keeps last_item in sync with tail's previous item
+ */
+static inline void update_last_item(list_t *list) {
+  list->last_item = list->tail->prev == list->head ? NULL : list->tail->prev;
+}
+
+
+/**
+ * @function Links new item between two neighbour items
+ */
+static inline void link_list_item(list_item_t *item, list_item_t *prev_item, list_item_t *next_item) {
+  item->prev = prev_item;
+  item->next = next_item;
+  prev_item->next = item;
+  next_item->prev = item;
+}
+
+
+/**
+ * @function Unlinks item from its neighbours
+ */
+static inline void unlink_list_item(list_item_t *item) {
+  item->prev->next = item->next;
+  item->next->prev = item->prev;
+}
+
+
 /**
  * @function Lists' item destructor
  * @brief Calls item's data destructor and free item's memory itself
@@ -78,7 +313,12 @@ void free_list_item(list_item_t *item) {
   }
 
   free_list_item_data(item->data);
+
+#ifndef LIST_NO_POOL
+  free_list_cell(container_of(item, list_cell_t, item));
+#else
   free(item);
+#endif
 }
 
 /**
@@ -88,18 +328,20 @@ void free_list_item(list_item_t *item) {
 list_t* init_list() {
 
   // init dummy tail
-  list_item_t* tail = init_list_item(NULL, NULL);
+  list_item_t* tail = init_list_item(NULL, NULL, NULL);
   if (!tail) {
     return NULL;
   }
 
   // init dummy head
-  list_item_t* head = init_list_item(NULL, tail);
+  list_item_t* head = init_list_item(NULL, NULL, tail);
   if (!head) {
     free_list_item(tail);
     return NULL;
   }
 
+  tail->prev = head;
+
   list_t *new_list = (list_t*) malloc(sizeof(list_t));
   if (!new_list) {
     free_list_item(tail);
@@ -121,22 +363,17 @@ list_t* init_list() {
  */
 list_item_t *add_item_to_head_of_list(list_t *list, list_item_data_t *item_data) {
 
-  list_item_t *new_list_item = init_list_item(item_data, NULL);
+  list_item_t *new_list_item = init_list_item(item_data, NULL, NULL);
   if (!new_list_item) {
     return NULL;
   }
 
-  list_item_t *current_head_next_item = list->head->next;
-
   // if list is empty, new_list_item is last item in list
-  if (current_head_next_item == list->tail) {
+  if (is_list_empty(list)) {
     list->last_item = new_list_item;
   }
 
-  // Make head point to the new item
-  // And new item to the head pointed to
-  list->head->next = new_list_item;
-  new_list_item->next = current_head_next_item;
+  link_list_item(new_list_item, list->head, list->head->next);
 
   return new_list_item;
 }
@@ -152,13 +389,12 @@ list_item_t *add_item_to_tail_of_list(list_t *list, list_item_data_t *item_data)
     return add_item_to_head_of_list(list, item_data);
   }
 
-  list_item_t *new_list_item = init_list_item(item_data, NULL);
+  list_item_t *new_list_item = init_list_item(item_data, NULL, NULL);
   if (!new_list_item) {
     return NULL;
   }
 
-  list->last_item->next = new_list_item;
-  new_list_item->next = list->tail;
+  link_list_item(new_list_item, list->last_item, list->tail);
   list->last_item = new_list_item;
 
   return new_list_item;
@@ -167,35 +403,43 @@ list_item_t *add_item_to_tail_of_list(list_t *list, list_item_data_t *item_data)
 
 /**
  * @function Removes item from list
- * @returns 0 on success, -1 if item was not found
+ * @brief Item should belong to the list, it is unlinked in O(1)
+ * @returns 0 on success, -1 if item is not an item of list
  */
 int remove_item_from_list(list_t *list, list_item_t *searched_item) {
 
-  list_item_t *prev_item = get_list_head(list);
-  list_item_t *current_item = prev_item->next;
-
-  while (current_item != get_list_tail(list) &&
-         current_item != searched_item) {
-    prev_item = current_item;
-    current_item = current_item->next;
-  }
-
-  // If current item is tail - not found
-  if (current_item == get_list_tail(list)) {
+  if (!searched_item || searched_item == list->head || searched_item == list->tail) {
     return -1;
   }
 
-  // if last item should be removed, change last_item pointer
-  if (current_item->next == list->tail) {
-    list->last_item = prev_item;
+  unlink_list_item(searched_item);
+
+  if (searched_item == list->last_item) {
+    update_last_item(list);
   }
-  prev_item->next = current_item->next;
-  free_list_item(current_item);
+
+  free_list_item(searched_item);
 
   return 0;
 }
 
 
+/**
+ * @function Unlinks first item of non-empty list and frees it
+ * @returns pointer to item's data
+ */
+static inline void *remove_first_list_item(list_t *list) {
+
+  list_item_t *first_item = list->head->next;
+  void *first_item_data = first_item->data->data_ptr;
+
+  unlink_list_item(first_item);
+  free_list_item(first_item);
+
+  return first_item_data;
+}
+
+
 /**
  * @function removes first item from list
  * @returns pointer to item's data
@@ -206,16 +450,33 @@ void *remove_and_get_item_data_from_head(list_t *list){
     return NULL;
   }
 
-  list_item_t *first_item = list->head->next;
-  void *first_item_data = first_item->data->data_ptr;
+  int is_last_item = list->head->next == list->last_item;
+  void *first_item_data = remove_first_list_item(list);
 
-  list->head->next = first_item->next;
-  free_list_item(first_item);
+  if (is_last_item) {
+    update_last_item(list);
+  }
 
   return first_item_data;
 }
 
 
+/**
+ * @function removes first item from list, that has more than one item
+ * @brief Neither reads nor writes last_item, so other thread may add
+ *        items to tail meanwhile, see ts_list.c
+ * @returns pointer to item's data
+ */
+void *remove_and_get_item_data_from_head_keep_last(list_t *list){
+
+  if (is_list_empty(list)) {
+    return NULL;
+  }
+
+  return remove_first_list_item(list);
+}
+
+
 /**
  * @function removes last item from list
  * @returns pointer to item's data
@@ -229,15 +490,8 @@ void *remove_and_get_item_data_from_tail(list_t *list) {
   list_item_t *last_item = list->last_item;
   void *item_data = last_item->data->data_ptr;
 
-  // TODO: get rid of linear complexity
-  //       to find find prev to last item
-  list_item_t *current_item = list->head;
-  while (current_item->next != last_item) {
-    current_item = current_item->next;
-  }
-
-  current_item->next = last_item->next;
-  list->last_item = current_item == list->head ? NULL : current_item;
+  unlink_list_item(last_item);
+  update_last_item(list);
   free_list_item(last_item);
 
   return item_data;
@@ -264,6 +518,7 @@ int clean_list(list_t *list) {
   }
 
   get_list_head(list)->next = current_item;
+  current_item->prev = get_list_head(list);
   list->last_item = NULL;
 
   return deleted_items_counter;
@@ -284,36 +539,232 @@ void close_list(list_t *list) {
   free(list);
 }
 
-list_item_t *reverse_list_inner(list_item_t *tail, list_item_t *current) {
+/**
+ * @function Reverses list
+ * @brief Swaps links of every item, dummy ones included, in one pass
+ */
+void reverse_list(list_t *list) {
+
+  list_item_t *current_item = list->head;
 
-  if (current == tail) {
-    return tail;
+  while (current_item) {
+    list_item_t *next_item = current_item->next;
+    current_item->next = current_item->prev;
+    current_item->prev = next_item;
+    current_item = next_item;
   }
 
-  list_item_t *prev_to = reverse_list_inner(tail, current->next);
-  prev_to->next = current;
+  // swap(list->head, list->tail)
+  list_item_t *tmp = list->head;
+  list->head = list->tail;
+  list->tail = tmp;
 
-  return current;
+  // first elements becomes last one
+  update_last_item(list);
 }
 
 
 /**
- * @function Reverses list
+ * @function Moves all items of source to the tail of destination
+ * @brief Relinks first and last items only, source becomes empty.
+ *        List spliced into itself is left as is
  */
-void reverse_list(list_t *list) {
+void list_splice_tail(list_t *destination, list_t *source) {
 
-  // first elements becomes last one
-  if (!is_list_empty(list)) {
-    list->last_item = list->head->next;
+  if (destination == source || is_list_empty(source)) {
+    return;
   }
 
-  list_item_t *last_item = reverse_list_inner(list->tail, list->head->next);
-  last_item->next = list->head;
+  list_item_t *first_item = source->head->next;
+  list_item_t *last_item = source->tail->prev;
 
-  // swap(list->head, list->tail)
-  list_item_t *tmp = list->head;
-  list->head = list->tail;
-  list->tail = tmp;
+  // detach all items from source
+  source->head->next = source->tail;
+  source->tail->prev = source->head;
+  source->last_item = NULL;
+
+  first_item->prev = destination->tail->prev;
+  destination->tail->prev->next = first_item;
+  last_item->next = destination->tail;
+  destination->tail->prev = last_item;
+  destination->last_item = last_item;
+}
+
+
+/**
+ * @function Appends items of second list to the first one and closes second
+ * @returns first list
+ */
+list_t *list_concat(list_t *first, list_t *second) {
+
+  list_splice_tail(first, second);
+  close_list(second);
+
+  return first;
+}
+
+
+/**
+ * @function Splits list before item, item should belong to the list
+ * @brief If item is NULL, head or tail, list is left as is
+ * @returns new list with item and all items after it, empty new list
+ *          if item is NULL, head or tail, or NULL if error
+ */
+list_t *list_split_at(list_t *list, list_item_t *item) {
+
+  list_t *new_list = init_list();
+  if (!new_list || !item || item == list->head || item == list->tail) {
+    return new_list;
+  }
+
+  list_item_t *prev_item = item->prev;
+  list_item_t *last_item = list->tail->prev;
+
+  prev_item->next = list->tail;
+  list->tail->prev = prev_item;
+  update_last_item(list);
+
+  item->prev = new_list->head;
+  new_list->head->next = item;
+  last_item->next = new_list->tail;
+  new_list->tail->prev = last_item;
+  new_list->last_item = last_item;
+
+  return new_list;
+}
+
+
+/**
+ * @function Moves all items to a new list, so they can be handled
+ *           without holding lock of the old one
+ * @returns new list or NULL if error
+ */
+list_t *list_steal_all(list_t *list) {
+
+  list_t *new_list = init_list();
+  if (!new_list) {
+    return NULL;
+  }
+
+  list_splice_tail(new_list, list);
+
+  return new_list;
+}
+
+
+/**
+ * @function Sorts list in place, equal items keep their order
+ * @brief Bottom-up merge sort: merges runs of 1, 2, 4... items while
+ *        walking the chain, so it takes no extra memory and no recursion
+ */
+void sort_list(list_t *list, list_compare_func_t compare) {
+
+  if (is_list_empty(list)) {
+    return;
+  }
+
+  // items are merged as NULL terminated chain, dummies are relinked at the end
+  list_item_t *chain = list->head->next;
+  list_item_t *chain_tail = list->tail->prev;
+  chain_tail->next = NULL;
+
+  for (size_t run_size = 1;; run_size *= 2) {
+
+    list_item_t *left = chain;
+    size_t number_of_merges = 0;
+
+    chain = NULL;
+    chain_tail = NULL;
+
+    while (left) {
+
+      ++number_of_merges;
+
+      list_item_t *right = left;
+      size_t left_size = 0;
+      while (left_size < run_size && right) {
+        ++left_size;
+        right = right->next;
+      }
+
+      size_t right_size = run_size;
+
+      while (left_size || (right_size && right)) {
+
+        list_item_t *item;
+
+        // on equal data left run goes first, that keeps sort stable
+        if (!left_size) {
+          item = right;
+          right = right->next;
+          --right_size;
+        } else if (!right_size || !right || (*compare)(left->data->data_ptr, right->data->data_ptr) <= 0) {
+          item = left;
+          left = left->next;
+          --left_size;
+        } else {
+          item = right;
+          right = right->next;
+          --right_size;
+        }
+
+        if (chain_tail) {
+          chain_tail->next = item;
+        } else {
+          chain = item;
+        }
+
+        item->prev = chain_tail;
+        chain_tail = item;
+      }
+
+      left = right;
+    }
+
+    chain_tail->next = NULL;
+
+    if (number_of_merges <= 1) {
+      break;
+    }
+  }
+
+  list->head->next = chain;
+  chain->prev = list->head;
+  chain_tail->next = list->tail;
+  list->tail->prev = chain_tail;
+  update_last_item(list);
+}
+
+
+/**
+ * @function Merges sorted source into sorted destination, source becomes empty
+ * @brief Items of destination go before equal items of source. Rest of
+ *        source, that is greater than destination's last item, is spliced at once
+ */
+void merge_sorted_lists(list_t *destination, list_t *source, list_compare_func_t compare) {
+
+  list_item_t *destination_item = destination->head->next;
+
+  while (!is_list_empty(source)) {
+
+    if (destination_item == destination->tail) {
+      list_splice_tail(destination, source);
+      return;
+    }
+
+    list_item_t *source_item = source->head->next;
+
+    if ((*compare)(destination_item->data->data_ptr, source_item->data->data_ptr) <= 0) {
+      destination_item = destination_item->next;
+      continue;
+    }
+
+    unlink_list_item(source_item);
+    link_list_item(source_item, destination_item->prev, destination_item);
+  }
+
+  update_last_item(source);
+  update_last_item(destination);
 }
 
 
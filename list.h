@@ -1,3 +1,6 @@
+#include <stddef.h>
+
+
 /**
  * @struct List's item data
  *
@@ -13,20 +16,28 @@ typedef struct list_item_data_t_ {
 /**
  * @struct List's item
  *
+ * Item owns its data: free_list_item frees data with the item. Data
+ * and item have memory of their own, so data of a linked item may be
+ * freed with free_list_item_data (or retired with EBR), after item
+ * is pointed to other data. Data is given to one item at a time.
+ *
  * @prop {data} item data
+ * @prop {prev} pointer to previous list's item
  * @prop {next} pointer to next list's item
  */
 typedef struct list_item_t_ {
   list_item_data_t *data;
+  struct list_item_t_ *prev;
   struct list_item_t_ *next;
 } list_item_t;
 
 
 /**
- * @struct Linked list
+ * @struct Doubly linked list
  *
  * @prop {head} list's head(dummy list item)
  * @prop {tail} list's tail(dummy list item)
+ * @prop {last_item} item before tail, NULL if list is empty
  */
 typedef struct {
   list_item_t *head;
@@ -41,6 +52,12 @@ list_t* init_list();
 list_item_data_t *init_list_item_data(void *data, void(*free_func)(void*));
 
 
+void free_list_item_data(list_item_data_t *lid);
+
+
+void free_list_item(list_item_t *item);
+
+
 static inline list_item_t *get_list_head(list_t *list) {
   return list->head;
 }
@@ -83,6 +100,9 @@ int remove_item_from_list(list_t *list, list_item_t *searched_item);
 void *remove_and_get_item_data_from_head(list_t *list);
 
 
+void *remove_and_get_item_data_from_head_keep_last(list_t *list);
+
+
 void *remove_and_get_item_data_from_tail(list_t *list);
 
 
@@ -94,3 +114,148 @@ void close_list(list_t *list);
 
 void reverse_list(list_t *list);
 
+
+void list_splice_tail(list_t *destination, list_t *source);
+
+
+list_t *list_concat(list_t *first, list_t *second);
+
+
+list_t *list_split_at(list_t *list, list_item_t *item);
+
+
+list_t *list_steal_all(list_t *list);
+
+
+/**
+ * @typedef compares data of two items like strcmp, gets data pointers
+ */
+typedef int (*list_compare_func_t)(void*, void*);
+
+
+void sort_list(list_t *list, list_compare_func_t compare);
+
+
+void merge_sorted_lists(list_t *destination, list_t *source, list_compare_func_t compare);
+
+
+/*
+ * Intrusive list
+ *
+ * Links are embedded into user's struct, list only chains them, so
+ * insert and remove allocate nothing. Struct is recovered from its
+ * link with container_of:
+ *
+ *     typedef struct { int value; list_link_t link; } my_item_t;
+ *
+ *     list_link_t *link = remove_and_get_link_from_head(&list);
+ *     my_item_t *item = container_of(link, my_item_t, link);
+ *
+ * Owner of struct frees it, list never does.
+ */
+
+
+#ifndef container_of
+#define container_of(ptr, type, member) ((type*) ((char*) (ptr) - offsetof(type, member)))
+#endif
+
+
+/**
+ * @struct Link embedded into item of intrusive list
+ */
+typedef struct list_link_t_ {
+  struct list_link_t_ *prev;
+  struct list_link_t_ *next;
+} list_link_t;
+
+
+/**
+ * @struct Intrusive doubly linked list
+ *
+ * @prop {sentinel} link before first and after last one, list is empty
+ *                  when it points to itself
+ */
+typedef struct {
+  list_link_t sentinel;
+} intrusive_list_t;
+
+
+static inline void init_intrusive_list(intrusive_list_t *list) {
+  list->sentinel.prev = &list->sentinel;
+  list->sentinel.next = &list->sentinel;
+}
+
+
+static inline int is_intrusive_list_empty(intrusive_list_t *list) {
+  return list->sentinel.next == &list->sentinel;
+}
+
+
+static inline list_link_t *get_link_from_head_of_list(intrusive_list_t *list) {
+  return is_intrusive_list_empty(list) ? NULL : list->sentinel.next;
+}
+
+
+static inline list_link_t *get_link_from_tail_of_list(intrusive_list_t *list) {
+  return is_intrusive_list_empty(list) ? NULL : list->sentinel.prev;
+}
+
+
+static inline void insert_link_between(list_link_t *link, list_link_t *prev_link, list_link_t *next_link) {
+  link->prev = prev_link;
+  link->next = next_link;
+  prev_link->next = link;
+  next_link->prev = link;
+}
+
+
+static inline void add_link_to_head_of_list(intrusive_list_t *list, list_link_t *link) {
+  insert_link_between(link, &list->sentinel, list->sentinel.next);
+}
+
+
+static inline void add_link_to_tail_of_list(intrusive_list_t *list, list_link_t *link) {
+  insert_link_between(link, list->sentinel.prev, &list->sentinel);
+}
+
+
+/**
+ * @function unlinks link from the list it is in
+ */
+static inline void remove_link_from_list(list_link_t *link) {
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->prev = link;
+  link->next = link;
+}
+
+
+static inline list_link_t *remove_and_get_link_from_head(intrusive_list_t *list) {
+
+  list_link_t *link = get_link_from_head_of_list(list);
+
+  if (link) {
+    remove_link_from_list(link);
+  }
+
+  return link;
+}
+
+
+static inline list_link_t *remove_and_get_link_from_tail(intrusive_list_t *list) {
+
+  list_link_t *link = get_link_from_tail_of_list(list);
+
+  if (link) {
+    remove_link_from_list(link);
+  }
+
+  return link;
+}
+
+
+/**
+ * @function iterates over links of list, current link may not be removed
+ */
+#define for_each_link_of_list(list, link) \
+  for (list_link_t *link = (list)->sentinel.next; link != &(list)->sentinel; link = link->next)
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int NUMBER_OF_ITEMS = 1000000;
+const int NUMBER_OF_ROUNDS = 5;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void do_nothing(void *data) {
+  (void) data;
+}
+
+
+/**
+ * @function fills list, walks it and empties it again, round after round
+ * @returns  0 if every item has been seen and removed
+ */
+int bench_insert_traverse_remove() {
+
+  double insert_sec = 0;
+  double traverse_sec = 0;
+  double remove_sec = 0;
+  long checksum = 0;
+
+  list_t *list = init_list();
+
+  for (int round = 0; round < NUMBER_OF_ROUNDS; ++round) {
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long i = 0; i < NUMBER_OF_ITEMS; ++i) {
+      add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    insert_sec += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (list_item_t *item = get_list_head(list)->next; item != get_list_tail(list); item = item->next) {
+      checksum += (long) get_list_item_data(item);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    traverse_sec += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (!is_list_empty(list)) {
+      remove_item_from_list(list, get_item_from_head_of_list(list));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    remove_sec += get_time_diff_sec(&start, &end);
+  }
+
+  close_list(list);
+
+  double operations = (double) NUMBER_OF_ITEMS * NUMBER_OF_ROUNDS;
+
+  printf("insert:   %6.2f ns/item\n", insert_sec / operations * 1e9);
+  printf("traverse: %6.2f ns/item\n", traverse_sec / operations * 1e9);
+  printf("remove:   %6.2f ns/item\n", remove_sec / operations * 1e9);
+
+  long expected_checksum = (long) NUMBER_OF_ITEMS * (NUMBER_OF_ITEMS - 1) / 2 * NUMBER_OF_ROUNDS;
+
+  if (checksum != expected_checksum) {
+    printf("bench_insert_traverse_remove: Failure. Checksum = %ld\n", checksum);
+    return 1;
+  }
+
+  return 0;
+}
+
+
+
+// ------------------------------------------------------
+// ------------------------ Tests -----------------------
+// ------------------------------------------------------
+
+
+/**
+ * @returns list with data from, from + 1, ... to - 1
+ */
+static list_t *init_range_list(long from, long to) {
+
+  list_t *list = init_list();
+
+  for (long i = from; i < to; ++i) {
+    add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+  }
+
+  return list;
+}
+
+
+/**
+ * @function checks data of items in order, back links and last_item
+ * @returns  1 if list holds exactly data from, from + 1, ... to - 1
+ */
+static int is_range_list(list_t *list, long from, long to) {
+
+  list_item_t *prev_item = get_list_head(list);
+  long expected = from;
+
+  for (list_item_t *item = prev_item->next; item != get_list_tail(list); item = item->next) {
+
+    if (expected >= to || (long) get_list_item_data(item) != expected || item->prev != prev_item) {
+      return 0;
+    }
+
+    prev_item = item;
+    ++expected;
+  }
+
+  list_item_t *last_item = from == to ? NULL : prev_item;
+
+  return expected == to && get_list_tail(list)->prev == prev_item && list->last_item == last_item;
+}
+
+
+/**
+ * @function checks splice of empty, single item and longer lists, list into itself too
+ * @returns  0 on success
+ */
+int test_list_splice_tail() {
+
+  int is_ok = 1;
+
+  list_t *destination = init_range_list(0, 2);
+  list_t *source = init_range_list(2, 5);
+
+  list_splice_tail(destination, source);
+  is_ok &= is_range_list(destination, 0, 5) && is_range_list(source, 0, 0);
+
+  list_splice_tail(destination, source);
+  is_ok &= is_range_list(destination, 0, 5);
+
+  list_splice_tail(destination, destination);
+  is_ok &= is_range_list(destination, 0, 5);
+
+  close_list(destination);
+
+  destination = init_list();
+  list_t *single = init_range_list(0, 1);
+
+  list_splice_tail(destination, single);
+  is_ok &= is_range_list(destination, 0, 1) && is_range_list(single, 0, 0);
+
+  // list stays usable after splice
+  add_item_to_tail_of_list(single, init_list_item_data((void*) 1, do_nothing));
+  list_splice_tail(destination, single);
+  is_ok &= is_range_list(destination, 0, 2);
+
+  close_list(destination);
+  close_list(single);
+  close_list(source);
+
+  printf("test_list_splice_tail: %s\n", is_ok ? "Success" : "Failure");
+
+  return !is_ok;
+}
+
+
+/**
+ * @function checks split at middle, first and last items and at NULL and dummies
+ * @returns  0 on success
+ */
+int test_list_split_at() {
+
+  int is_ok = 1;
+
+  list_t *list = init_range_list(0, 5);
+
+  list_t *new_list = list_split_at(list, list->head->next->next->next);
+  is_ok &= is_range_list(list, 0, 2) && is_range_list(new_list, 2, 5);
+  close_list(new_list);
+
+  new_list = list_split_at(list, list->last_item);
+  is_ok &= is_range_list(list, 0, 1) && is_range_list(new_list, 1, 2);
+  close_list(new_list);
+
+  new_list = list_split_at(list, list->head->next);
+  is_ok &= is_range_list(list, 0, 0) && is_range_list(new_list, 0, 1);
+  close_list(new_list);
+
+  close_list(list);
+  list = init_range_list(0, 3);
+
+  list_item_t *bad_items[] = { NULL, get_list_head(list), get_list_tail(list) };
+
+  for (int i = 0; i < 3; ++i) {
+    new_list = list_split_at(list, bad_items[i]);
+    is_ok &= new_list && is_range_list(list, 0, 3) && is_range_list(new_list, 0, 0);
+    close_list(new_list);
+  }
+
+  close_list(list);
+
+  printf("test_list_split_at: %s\n", is_ok ? "Success" : "Failure");
+
+  return !is_ok;
+}
+
+
+/**
+ * @function checks concat and steal all with empty and non-empty lists
+ * @returns  0 on success
+ */
+int test_list_concat_and_steal_all() {
+
+  int is_ok = 1;
+
+  list_t *list = list_concat(init_range_list(0, 2), init_list());
+  is_ok &= is_range_list(list, 0, 2);
+
+  list = list_concat(list, init_range_list(2, 3));
+  is_ok &= is_range_list(list, 0, 3);
+
+  list_t *empty_list = list_concat(init_list(), list_steal_all(list));
+  is_ok &= is_range_list(empty_list, 0, 3) && is_range_list(list, 0, 0);
+
+  list_t *stolen_list = list_steal_all(list);
+  is_ok &= is_range_list(stolen_list, 0, 0) && is_range_list(list, 0, 0);
+
+  // old list stays usable after its items are stolen
+  add_item_to_tail_of_list(list, init_list_item_data((void*) 0, do_nothing));
+  is_ok &= is_range_list(list, 0, 1);
+
+  close_list(list);
+  close_list(empty_list);
+  close_list(stolen_list);
+
+  printf("test_list_concat_and_steal_all: %s\n", is_ok ? "Success" : "Failure");
+
+  return !is_ok;
+}
+
+
+/**
+ * @function frees data of linked item and links item with foreign data
+ * @brief    Item and its data should not share memory, otherwise freed
+ *           data takes item with it and next allocations reuse it
+ * @returns  0 on success
+ */
+int test_free_data_of_linked_item() {
+
+  list_t *list = init_range_list(0, 4);
+  list_item_t *item = list->head->next->next;
+
+  // item gets new data first, as it frees its current data itself
+  list_item_data_t *old_item_data = item->data;
+  item->data = init_list_item_data((void*) 1, do_nothing);
+  free_list_item_data(old_item_data);
+
+  // data, that list does not own, is given back before item is freed
+  list_item_data_t foreign_item_data = { (void*) 4, do_nothing };
+  list_item_t *foreign_item = add_item_to_tail_of_list(list, &foreign_item_data);
+
+  // cells freed above are reused here
+  for (long i = 5; i < 1000; ++i) {
+    add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+  }
+
+  int is_ok = is_range_list(list, 0, 1000) && foreign_item->data == &foreign_item_data;
+
+  foreign_item->data = init_list_item_data((void*) 4, do_nothing);
+  close_list(list);
+
+  printf("test_free_data_of_linked_item: %s\n", is_ok ? "Success" : "Failure");
+
+  return !is_ok;
+}
+
+int main() {
+
+#ifdef LIST_NO_POOL
+  printf("list_t with malloc per item and data\n");
+#else
+  printf("list_t with cell pool\n");
+#endif
+
+  int result = 0;
+
+  result |= test_list_splice_tail();
+  result |= test_list_split_at();
+  result |= test_list_concat_and_steal_all();
+  result |= test_free_data_of_linked_item();
+  result |= bench_insert_traverse_remove();
+
+  printf(result ? "Failure\n" : "Success\n");
+
+  return result;
+}
@@ -0,0 +1,254 @@
+#ifdef LOCK_PROFILING
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifndef ST_LOCK_PROFILE_
+#define ST_LOCK_PROFILE_
+#include "lock_profile.h"
+#endif
+
+// locks held by thread at once
+#define LOCK_PROFILE_MAX_HELD 16
+
+/*
+ * Statistics of one site, written by owner thread only,
+ * atomics let dump read them while thread runs
+ */
+typedef struct {
+    _Atomic uint64_t acquisitions;
+    _Atomic uint64_t contended_acquisitions;
+    _Atomic uint64_t wait_ns;
+    _Atomic uint64_t hold_ns;
+    _Atomic uint64_t wait_histogram[LOCK_PROFILE_HISTOGRAM_SIZE];
+    _Atomic uint64_t hold_histogram[LOCK_PROFILE_HISTOGRAM_SIZE];
+} lock_profile_stats_t;
+
+typedef struct {
+    void *lock;
+    int site_id;
+    uint64_t acquired_at;
+} held_lock_t;
+
+typedef struct lock_profile_buffer_ {
+    lock_profile_stats_t stats[LOCK_PROFILE_MAX_SITES];
+    held_lock_t held_locks[LOCK_PROFILE_MAX_HELD];
+    int number_of_held_locks;
+    struct lock_profile_buffer_ *next;
+} lock_profile_buffer_t;
+
+/*
+ * Merged statistics of site for report
+ */
+typedef struct {
+    lock_profile_site_t *site;
+    uint64_t acquisitions;
+    uint64_t contended_acquisitions;
+    uint64_t wait_ns;
+    uint64_t hold_ns;
+    uint64_t wait_histogram[LOCK_PROFILE_HISTOGRAM_SIZE];
+    uint64_t hold_histogram[LOCK_PROFILE_HISTOGRAM_SIZE];
+} lock_profile_report_t;
+
+// protects sites and list of buffers, buffers outlive their threads
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+static lock_profile_site_t *sites[LOCK_PROFILE_MAX_SITES];
+static int number_of_sites = 0;
+static lock_profile_buffer_t *buffers = NULL;
+
+static _Thread_local lock_profile_buffer_t *local_buffer = NULL;
+
+static lock_profile_buffer_t *get_local_buffer() {
+
+    if (local_buffer) {
+        return local_buffer;
+    }
+
+    local_buffer = (lock_profile_buffer_t*) calloc(1, sizeof(lock_profile_buffer_t));
+
+    if (local_buffer) {
+        pthread_mutex_lock(&registry_mutex);
+        local_buffer->next = buffers;
+        buffers = local_buffer;
+        pthread_mutex_unlock(&registry_mutex);
+    }
+
+    return local_buffer;
+}
+
+/*
+ * Returns site id, -1 if there are too many sites
+ */
+static int get_site_id(lock_profile_site_t *site) {
+
+    int id = atomic_load_explicit(&site->id, memory_order_acquire);
+
+    if (id >= 0) {
+        return id;
+    }
+
+    pthread_mutex_lock(&registry_mutex);
+
+    id = atomic_load_explicit(&site->id, memory_order_relaxed);
+
+    if (id < 0 && number_of_sites < LOCK_PROFILE_MAX_SITES) {
+        id = number_of_sites++;
+        sites[id] = site;
+        atomic_store_explicit(&site->id, id, memory_order_release);
+    }
+
+    pthread_mutex_unlock(&registry_mutex);
+
+    return id;
+}
+
+static inline void add_to_counter(_Atomic uint64_t *counter, uint64_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+static inline int get_histogram_bucket(uint64_t ns) {
+    int bucket = ns ? 64 - __builtin_clzll(ns) : 0;
+    return bucket < LOCK_PROFILE_HISTOGRAM_SIZE ? bucket : LOCK_PROFILE_HISTOGRAM_SIZE - 1;
+}
+
+void lock_profile_acquired(lock_profile_site_t *site, void *lock, uint64_t started_at, bool is_contended) {
+
+    uint64_t now = lock_profile_now();
+
+    lock_profile_buffer_t *buffer = get_local_buffer();
+    int site_id = get_site_id(site);
+
+    if (!buffer || site_id < 0) {
+        return;
+    }
+
+    lock_profile_stats_t *stats = buffer->stats + site_id;
+    uint64_t wait_ns = now - started_at;
+
+    add_to_counter(&stats->acquisitions, 1);
+    add_to_counter(&stats->contended_acquisitions, is_contended);
+    add_to_counter(&stats->wait_ns, wait_ns);
+    add_to_counter(stats->wait_histogram + get_histogram_bucket(wait_ns), 1);
+
+    // hold time of too deep nesting is not tracked
+    if (buffer->number_of_held_locks < LOCK_PROFILE_MAX_HELD) {
+        held_lock_t *held_lock = buffer->held_locks + buffer->number_of_held_locks++;
+        held_lock->lock = lock;
+        held_lock->site_id = site_id;
+        held_lock->acquired_at = now;
+    }
+}
+
+/*
+ * Locks are not always released in reverse order,
+ * so held lock is searched from the top
+ */
+void lock_profile_released(void *lock) {
+
+    lock_profile_buffer_t *buffer = local_buffer;
+
+    if (!buffer) {
+        return;
+    }
+
+    for (int i = buffer->number_of_held_locks - 1; i >= 0; --i) {
+
+        held_lock_t *held_lock = buffer->held_locks + i;
+
+        if (held_lock->lock != lock) {
+            continue;
+        }
+
+        uint64_t hold_ns = lock_profile_now() - held_lock->acquired_at;
+        lock_profile_stats_t *stats = buffer->stats + held_lock->site_id;
+
+        add_to_counter(&stats->hold_ns, hold_ns);
+        add_to_counter(stats->hold_histogram + get_histogram_bucket(hold_ns), 1);
+
+        for (int j = i + 1; j < buffer->number_of_held_locks; ++j) {
+            buffer->held_locks[j - 1] = buffer->held_locks[j];
+        }
+        --buffer->number_of_held_locks;
+
+        return;
+    }
+}
+
+static int compare_by_wait_time(const void *first, const void *second) {
+
+    uint64_t first_wait_ns = ((const lock_profile_report_t*) first)->wait_ns;
+    uint64_t second_wait_ns = ((const lock_profile_report_t*) second)->wait_ns;
+
+    return (first_wait_ns < second_wait_ns) - (first_wait_ns > second_wait_ns);
+}
+
+static void print_histogram(FILE *stream, const char *title, uint64_t *histogram) {
+
+    fprintf(stream, "    %s:", title);
+
+    for (int i = 0; i < LOCK_PROFILE_HISTOGRAM_SIZE; ++i) {
+        if (histogram[i]) {
+            fprintf(stream, " <2^%d:%lu", i, (unsigned long) histogram[i]);
+        }
+    }
+
+    fprintf(stream, "\n");
+}
+
+void lock_profile_dump(FILE *stream) {
+
+    lock_profile_report_t reports[LOCK_PROFILE_MAX_SITES] = { 0 };
+
+    pthread_mutex_lock(&registry_mutex);
+
+    int number_of_reports = number_of_sites;
+
+    for (int i = 0; i < number_of_reports; ++i) {
+
+        lock_profile_report_t *report = reports + i;
+        report->site = sites[i];
+
+        for (lock_profile_buffer_t *buffer = buffers; buffer; buffer = buffer->next) {
+
+            lock_profile_stats_t *stats = buffer->stats + i;
+
+            report->acquisitions += atomic_load_explicit(&stats->acquisitions, memory_order_relaxed);
+            report->contended_acquisitions += atomic_load_explicit(&stats->contended_acquisitions, memory_order_relaxed);
+            report->wait_ns += atomic_load_explicit(&stats->wait_ns, memory_order_relaxed);
+            report->hold_ns += atomic_load_explicit(&stats->hold_ns, memory_order_relaxed);
+
+            for (int j = 0; j < LOCK_PROFILE_HISTOGRAM_SIZE; ++j) {
+                report->wait_histogram[j] += atomic_load_explicit(stats->wait_histogram + j, memory_order_relaxed);
+                report->hold_histogram[j] += atomic_load_explicit(stats->hold_histogram + j, memory_order_relaxed);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&registry_mutex);
+
+    qsort(reports, number_of_reports, sizeof(lock_profile_report_t), compare_by_wait_time);
+
+    fprintf(stream, "Lock profile, sites ranked by total wait time\n");
+
+    for (int i = 0; i < number_of_reports; ++i) {
+
+        lock_profile_report_t *report = reports + i;
+
+        if (!report->acquisitions) {
+            continue;
+        }
+
+        fprintf(stream, "#%d %s at %s:%d\n", i + 1,
+                report->site->lock_name, report->site->file, report->site->line);
+        fprintf(stream, "    acquisitions %lu, contended %lu (%.1f%%), wait total %.3f ms, avg %.0f ns, hold avg %.0f ns\n",
+                (unsigned long) report->acquisitions, (unsigned long) report->contended_acquisitions,
+                100.0 * report->contended_acquisitions / report->acquisitions,
+                report->wait_ns * 1e-6, (double) report->wait_ns / report->acquisitions,
+                (double) report->hold_ns / report->acquisitions);
+        print_histogram(stream, "wait ns", report->wait_histogram);
+        print_histogram(stream, "hold ns", report->hold_histogram);
+    }
+}
+
+#endif
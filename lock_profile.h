@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Lock contention profiling
+ *
+ * Compiled in with -DLOCK_PROFILING only. Wrapped acquisition first
+ * tries the lock, failed try is counted as contended acquisition, then
+ * it waits with the regular lock call. Statistics are kept per call
+ * site in per-thread buffers, so profiling adds no shared writes
+ * besides the lock itself:
+ *     acquisitions and contended acquisitions,
+ *     wait time and hold time, totals and log2 histograms in ns.
+ *
+ * lock_profile_dump merges buffers of all threads and prints sites
+ * ranked by total wait time.
+ *
+ * Without LOCK_PROFILING wrappers expand to plain lock calls.
+ */
+
+#define PROFILED_ADAPTIVE_MUTEX_LOCK(m) \
+    LOCK_PROFILE_ACQUIRE(m, adaptive_mutex_trylock(m), adaptive_mutex_lock(m))
+
+#define PROFILED_ADAPTIVE_MUTEX_UNLOCK(m) \
+    LOCK_PROFILE_RELEASE(m, adaptive_mutex_unlock(m))
+
+#define PROFILED_PTHREAD_MUTEX_LOCK(m) \
+    LOCK_PROFILE_ACQUIRE(m, pthread_mutex_trylock(m), pthread_mutex_lock(m))
+
+#define PROFILED_PTHREAD_MUTEX_UNLOCK(m) \
+    LOCK_PROFILE_RELEASE(m, pthread_mutex_unlock(m))
+
+#ifdef LOCK_PROFILING
+
+#define LOCK_PROFILE_MAX_SITES 64
+// bucket i counts times in [2^(i-1), 2^i) ns, the last one - all above
+#define LOCK_PROFILE_HISTOGRAM_SIZE 32
+
+/*
+ * Place in code, where lock is acquired
+ */
+typedef struct {
+    const char *lock_name;
+    const char *file;
+    int line;
+    // index in per-thread buffers, -1 until first acquisition
+    _Atomic int id;
+} lock_profile_site_t;
+
+static inline uint64_t lock_profile_now() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void lock_profile_acquired(lock_profile_site_t *site, void *lock, uint64_t started_at, bool is_contended);
+
+void lock_profile_released(void *lock);
+
+void lock_profile_dump(FILE *stream);
+
+#define LOCK_PROFILE_ACQUIRE(lock, trylock_call, lock_call)                        \
+    do {                                                                           \
+        static lock_profile_site_t lock_profile_site_ = { #lock, __FILE__, __LINE__, -1 }; \
+        uint64_t lock_profile_started_at_ = lock_profile_now();                    \
+        bool lock_profile_is_contended_ = (trylock_call) != 0;                     \
+        if (lock_profile_is_contended_) {                                          \
+            lock_call;                                                             \
+        }                                                                          \
+        lock_profile_acquired(&lock_profile_site_, (lock),                         \
+                              lock_profile_started_at_, lock_profile_is_contended_); \
+    } while (0)
+
+#define LOCK_PROFILE_RELEASE(lock, unlock_call) \
+    do {                                        \
+        lock_profile_released(lock);            \
+        unlock_call;                            \
+    } while (0)
+
+#else
+
+#define LOCK_PROFILE_ACQUIRE(lock, trylock_call, lock_call) lock_call
+
+#define LOCK_PROFILE_RELEASE(lock, unlock_call) unlock_call
+
+#endif
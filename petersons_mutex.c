@@ -3,11 +3,23 @@
 #include <stdbool.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
 
 #define THREAD_IS_RUNNING_STATUS_VALUE 0
 #define THREAD_DESIRE_EXCLUSIVE_ACCESS 1
 #define MAX_INCREMENT_VALUE 50000
 
+#define TOURNAMENT_CACHE_LINE_SIZE 64
+#define TOURNAMENT_SPIN_LIMIT 1000
+#define MAX_BENCH_THREADS 16
+#define BENCH_DURATION_NS 200000000L
+
 typedef struct thread_flags_t_ {
     size_t size;
     volatile bool *array;
@@ -116,6 +128,129 @@ void unlock(size_t self) {
     thread_flags->array[self] = THREAD_IS_RUNNING_STATUS_VALUE;
 }
 
+/*
+ * Two-thread Peterson lock, node of tournament tree
+ *
+ * Each field has its own cache line, so the two contenders
+ * do not invalidate each other's flag while spinning
+ */
+typedef struct {
+    _Alignas(TOURNAMENT_CACHE_LINE_SIZE) atomic_bool left_flag;
+    _Alignas(TOURNAMENT_CACHE_LINE_SIZE) atomic_bool right_flag;
+    _Alignas(TOURNAMENT_CACHE_LINE_SIZE) _Atomic int turn;
+} peterson_node_t;
+
+/*
+ * Tournament tree of Peterson locks for N threads
+ *
+ * Nodes are stored as binary heap: root is 1, children of node i are
+ * 2i and 2i + 1, thread with id t starts from node (leaves + t) / 2.
+ * Thread wins O(log N) two-thread locks on its way to the root.
+ */
+typedef struct {
+    size_t number_of_leaves;
+    size_t height;
+    peterson_node_t *nodes;
+    _Atomic size_t next_thread_id;
+} tournament_lock_t;
+
+static inline atomic_bool *get_peterson_flag(peterson_node_t *node, int side) {
+    return side ? &node->right_flag : &node->left_flag;
+}
+
+tournament_lock_t *tournament_lock_init(size_t max_number_of_threads) {
+
+    tournament_lock_t *result_lock = (tournament_lock_t*) malloc(sizeof(tournament_lock_t));
+
+    if (result_lock == NULL) {
+        return NULL;
+    }
+
+    size_t number_of_leaves = 2;
+    size_t height = 1;
+    while (number_of_leaves < max_number_of_threads) {
+        number_of_leaves *= 2;
+        ++height;
+    }
+
+    // node 0 is not used
+    result_lock->nodes = (peterson_node_t*) aligned_alloc(TOURNAMENT_CACHE_LINE_SIZE,
+                                                          sizeof(peterson_node_t) * number_of_leaves);
+
+    if (result_lock->nodes == NULL) {
+        free(result_lock);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < number_of_leaves; ++i) {
+        atomic_init(&result_lock->nodes[i].left_flag, false);
+        atomic_init(&result_lock->nodes[i].right_flag, false);
+        atomic_init(&result_lock->nodes[i].turn, 0);
+    }
+
+    result_lock->number_of_leaves = number_of_leaves;
+    result_lock->height = height;
+    atomic_init(&result_lock->next_thread_id, 0);
+
+    return result_lock;
+}
+
+void tournament_lock_destroy(tournament_lock_t *tl) {
+    free(tl->nodes);
+    free(tl);
+}
+
+/*
+ * Assigns dense thread id, that should be passed to lock/unlock
+ *
+ * Returns -1 if all ids are taken
+ */
+long tournament_register_thread(tournament_lock_t *tl) {
+
+    size_t thread_id = atomic_fetch_add(&tl->next_thread_id, 1);
+
+    return thread_id < tl->number_of_leaves ? (long) thread_id : -1;
+}
+
+/*
+ * Classic Peterson entry, all accesses are seq_cst: own flag store
+ * must not be reordered with the load of the other flag
+ */
+static void peterson_node_lock(peterson_node_t *node, int side) {
+
+    atomic_store(get_peterson_flag(node, side), true);
+    atomic_store(&node->turn, side);
+
+    unsigned int spin_counter = 0;
+    while (atomic_load(get_peterson_flag(node, !side)) && atomic_load(&node->turn) == side) {
+        spin_wait_step(&spin_counter, TOURNAMENT_SPIN_LIMIT);
+    }
+}
+
+static void peterson_node_unlock(peterson_node_t *node, int side) {
+    atomic_store(get_peterson_flag(node, side), false);
+}
+
+void tournament_lock(tournament_lock_t *tl, size_t thread_id) {
+
+    for (size_t position = tl->number_of_leaves + thread_id; position > 1; position /= 2) {
+        peterson_node_lock(tl->nodes + position / 2, position % 2);
+    }
+}
+
+/*
+ * Releases nodes from the root down to the leaf
+ */
+void tournament_unlock(tournament_lock_t *tl, size_t thread_id) {
+
+    size_t leaf_position = tl->number_of_leaves + thread_id;
+
+    for (size_t level = tl->height; level > 0; --level) {
+        size_t position = leaf_position >> (level - 1);
+        peterson_node_unlock(tl->nodes + position / 2, position % 2);
+    }
+}
+
 void *perform_incrementing(void *args) {
 
     size_t self_thread_pid = (size_t*) args;
@@ -142,6 +277,98 @@ pthread_t *start_increment_thread() {
     return result_pid;
 }
 
+/*
+ * Benchmark input, same for both locks
+ */
+typedef struct {
+    tournament_lock_t *tl;
+    size_t thread_id;
+    atomic_bool *is_running;
+    pthread_barrier_t *start_barrier;
+    long acquisitions;
+} lock_bench_input_t;
+
+// protected by the lock under test
+long bench_shared_counter = 0;
+
+void *filter_lock_bench_worker(void *args) {
+
+    lock_bench_input_t *input = (lock_bench_input_t*) args;
+
+    pthread_barrier_wait(input->start_barrier);
+
+    while (atomic_load_explicit(input->is_running, memory_order_relaxed)) {
+        lock(input->thread_id);
+        ++bench_shared_counter;
+        unlock(input->thread_id);
+        ++input->acquisitions;
+    }
+
+    return NULL;
+}
+
+void *tournament_lock_bench_worker(void *args) {
+
+    lock_bench_input_t *input = (lock_bench_input_t*) args;
+
+    input->thread_id = tournament_register_thread(input->tl);
+
+    pthread_barrier_wait(input->start_barrier);
+
+    while (atomic_load_explicit(input->is_running, memory_order_relaxed)) {
+        tournament_lock(input->tl, input->thread_id);
+        ++bench_shared_counter;
+        tournament_unlock(input->tl, input->thread_id);
+        ++input->acquisitions;
+    }
+
+    return NULL;
+}
+
+/*
+ * Counts acquisitions of n threads during fixed time
+ */
+void bench_lock(const char *lock_name, void *(*worker)(void*), size_t number_of_threads) {
+
+    atomic_bool is_running = true;
+    pthread_barrier_t start_barrier;
+    pthread_barrier_init(&start_barrier, NULL, number_of_threads + 1);
+
+    tournament_lock_t *tl = tournament_lock_init(number_of_threads);
+    lock_init();
+
+    pthread_t thread_ids[MAX_BENCH_THREADS];
+    lock_bench_input_t inputs[MAX_BENCH_THREADS];
+
+    bench_shared_counter = 0;
+
+    for (size_t i = 0; i < number_of_threads; ++i) {
+        inputs[i] = (lock_bench_input_t) { tl, i, &is_running, &start_barrier, 0 };
+        pthread_create(thread_ids + i, NULL, worker, inputs + i);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+
+    struct timespec duration = { 0, BENCH_DURATION_NS };
+    nanosleep(&duration, NULL);
+
+    atomic_store(&is_running, false);
+
+    long acquisitions = 0;
+    for (size_t i = 0; i < number_of_threads; ++i) {
+        pthread_join(thread_ids[i], NULL);
+        acquisitions += inputs[i].acquisitions;
+    }
+
+    printf("%-10s threads=%2zu: %10.0f acquisitions/s, lost updates: %ld\n",
+           lock_name, number_of_threads, acquisitions / (BENCH_DURATION_NS * 1e-9),
+           acquisitions - bench_shared_counter);
+
+    lock_destroy();
+    tournament_lock_destroy(tl);
+    pthread_barrier_destroy(&start_barrier);
+}
+
 int main() {
 
     lock_init();
@@ -163,5 +390,10 @@ int main() {
 
     printf(expected_result_answer == result_answer_to_increment ? "Success\n" : "Failure\n");
 
+    for (size_t n = 2; n <= MAX_BENCH_THREADS; n *= 2) {
+        bench_lock("filter", filter_lock_bench_worker, n);
+        bench_lock("tournament", tournament_lock_bench_worker, n);
+    }
+
     return 0;    
 }
\ No newline at end of file
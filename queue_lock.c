@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <stdbool.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_QUEUE_LOCK_
+#define ST_QUEUE_LOCK_
+#include "queue_lock.h"
+#endif
+
+// spins before yielding CPU to preempted lock holder
+#define QUEUE_LOCK_SPIN_LIMIT 1000
+
+void mcs_lock_init(mcs_lock_t *lock) {
+    atomic_init(&lock->tail, NULL);
+}
+
+/*
+ * Node should stay valid until matching mcs_unlock
+ */
+void mcs_lock(mcs_lock_t *lock, mcs_node_t *self) {
+
+    atomic_store_explicit(&self->next, NULL, memory_order_relaxed);
+    atomic_store_explicit(&self->is_locked, true, memory_order_relaxed);
+
+    mcs_node_t *pred = atomic_exchange_explicit(&lock->tail, self, memory_order_acq_rel);
+
+    // lock was free
+    if (!pred) {
+        return;
+    }
+
+    atomic_store_explicit(&pred->next, self, memory_order_release);
+
+    unsigned int spin_counter = 0;
+    while (atomic_load_explicit(&self->is_locked, memory_order_acquire)) {
+        spin_wait_step(&spin_counter, QUEUE_LOCK_SPIN_LIMIT);
+    }
+}
+
+void mcs_unlock(mcs_lock_t *lock, mcs_node_t *self) {
+
+    mcs_node_t *next = atomic_load_explicit(&self->next, memory_order_acquire);
+
+    if (!next) {
+
+        // nobody is queued
+        mcs_node_t *expected_tail = self;
+        if (atomic_compare_exchange_strong_explicit(&lock->tail, &expected_tail, NULL,
+                                                    memory_order_release, memory_order_relaxed)) {
+            return;
+        }
+
+        // successor has swapped tail, but has not linked itself yet
+        unsigned int spin_counter = 0;
+        while (!(next = atomic_load_explicit(&self->next, memory_order_acquire))) {
+            spin_wait_step(&spin_counter, QUEUE_LOCK_SPIN_LIMIT);
+        }
+    }
+
+    atomic_store_explicit(&next->is_locked, false, memory_order_release);
+}
+
+static clh_node_t *init_clh_node(bool is_locked) {
+
+    clh_node_t *node = (clh_node_t*) aligned_alloc(QUEUE_LOCK_CACHE_LINE_SIZE, sizeof(clh_node_t));
+
+    if (node) {
+        atomic_init(&node->is_locked, is_locked);
+    }
+
+    return node;
+}
+
+/*
+ * Returns 0 on success, -1 if error
+ */
+int clh_lock_init(clh_lock_t *lock) {
+
+    // tail always points to some node, initially to released one
+    clh_node_t *dummy_node = init_clh_node(false);
+
+    if (!dummy_node) {
+        return -1;
+    }
+
+    atomic_init(&lock->tail, dummy_node);
+
+    return 0;
+}
+
+/*
+ * Function assumes lock is released
+ */
+void clh_lock_destroy(clh_lock_t *lock) {
+    free(atomic_load(&lock->tail));
+}
+
+/*
+ * Returns 0 on success, -1 if error
+ */
+int clh_handle_init(clh_handle_t *handle) {
+
+    handle->node = init_clh_node(false);
+    handle->pred = NULL;
+
+    return handle->node ? 0 : -1;
+}
+
+void clh_handle_destroy(clh_handle_t *handle) {
+    free(handle->node);
+    handle->node = NULL;
+}
+
+void clh_lock(clh_lock_t *lock, clh_handle_t *handle) {
+
+    atomic_store_explicit(&handle->node->is_locked, true, memory_order_relaxed);
+
+    clh_node_t *pred = atomic_exchange_explicit(&lock->tail, handle->node, memory_order_acq_rel);
+
+    unsigned int spin_counter = 0;
+    while (atomic_load_explicit(&pred->is_locked, memory_order_acquire)) {
+        spin_wait_step(&spin_counter, QUEUE_LOCK_SPIN_LIMIT);
+    }
+
+    handle->pred = pred;
+}
+
+void clh_unlock(clh_lock_t *lock, clh_handle_t *handle) {
+
+    // releasing needs only own node, lock is taken for symmetry with clh_lock
+    (void) lock;
+
+    clh_node_t *node = handle->node;
+
+    // predecessor's node is not used by anyone anymore, take it
+    handle->node = handle->pred;
+    handle->pred = NULL;
+
+    atomic_store_explicit(&node->is_locked, false, memory_order_release);
+}
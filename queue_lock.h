@@ -0,0 +1,57 @@
+#include <stdatomic.h>
+
+/*
+ * Queue locks
+ *
+ * Waiters form FIFO queue, each one spins on its own cache line
+ * padded node, so lock handoff touches one remote line and costs O(1)
+ * regardless of number of waiters.
+ *
+ * MCS - waiter spins on its own node, predecessor flips it on unlock.
+ * CLH - waiter spins on predecessor's node and takes it for reuse
+ *       after unlock, so nodes migrate between threads.
+ */
+#define QUEUE_LOCK_CACHE_LINE_SIZE 64
+
+typedef struct mcs_node_ {
+    _Alignas(QUEUE_LOCK_CACHE_LINE_SIZE) _Atomic(struct mcs_node_*) next;
+    atomic_bool is_locked;
+} mcs_node_t;
+
+typedef struct {
+    _Alignas(QUEUE_LOCK_CACHE_LINE_SIZE) _Atomic(mcs_node_t*) tail;
+} mcs_lock_t;
+
+typedef struct {
+    _Alignas(QUEUE_LOCK_CACHE_LINE_SIZE) atomic_bool is_locked;
+} clh_node_t;
+
+typedef struct {
+    _Alignas(QUEUE_LOCK_CACHE_LINE_SIZE) _Atomic(clh_node_t*) tail;
+} clh_lock_t;
+
+/*
+ * Per-thread CLH state, node changes after every unlock
+ */
+typedef struct {
+    clh_node_t *node;
+    clh_node_t *pred;
+} clh_handle_t;
+
+void mcs_lock_init(mcs_lock_t *lock);
+
+void mcs_lock(mcs_lock_t *lock, mcs_node_t *self);
+
+void mcs_unlock(mcs_lock_t *lock, mcs_node_t *self);
+
+int clh_lock_init(clh_lock_t *lock);
+
+void clh_lock_destroy(clh_lock_t *lock);
+
+int clh_handle_init(clh_handle_t *handle);
+
+void clh_handle_destroy(clh_handle_t *handle);
+
+void clh_lock(clh_lock_t *lock, clh_handle_t *handle);
+
+void clh_unlock(clh_lock_t *lock, clh_handle_t *handle);
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_QUEUE_LOCK_
+#define ST_QUEUE_LOCK_
+#include "queue_lock.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define MAX_NUMBER_OF_THREADS 16
+#define BENCH_DURATION_NS 200000000L
+
+typedef enum {
+    MCS_LOCK,
+    CLH_LOCK,
+    PTHREAD_MUTEX
+} lock_kind_t;
+
+static const char *LOCK_NAMES[] = { "mcs", "clh", "pthread_mutex" };
+
+typedef struct {
+    lock_kind_t kind;
+    mcs_lock_t mcs;
+    clh_lock_t clh;
+    pthread_mutex_t mutex;
+    atomic_bool is_running;
+    pthread_barrier_t start_barrier;
+    // protected by the lock under test
+    long shared_counter;
+} lock_bench_t;
+
+typedef struct {
+    lock_bench_t *bench;
+    long acquisitions;
+} lock_worker_input_t;
+
+static void *lock_worker(void *data) {
+
+    lock_worker_input_t *input = (lock_worker_input_t*) data;
+    lock_bench_t *bench = input->bench;
+
+    mcs_node_t mcs_node;
+    clh_handle_t clh_handle;
+    clh_handle_init(&clh_handle);
+
+    pthread_barrier_wait(&bench->start_barrier);
+
+    while (atomic_load_explicit(&bench->is_running, memory_order_relaxed)) {
+
+        switch (bench->kind) {
+        case MCS_LOCK:
+            mcs_lock(&bench->mcs, &mcs_node);
+            ++bench->shared_counter;
+            mcs_unlock(&bench->mcs, &mcs_node);
+            break;
+        case CLH_LOCK:
+            clh_lock(&bench->clh, &clh_handle);
+            ++bench->shared_counter;
+            clh_unlock(&bench->clh, &clh_handle);
+            break;
+        case PTHREAD_MUTEX:
+            pthread_mutex_lock(&bench->mutex);
+            ++bench->shared_counter;
+            pthread_mutex_unlock(&bench->mutex);
+            break;
+        }
+
+        ++input->acquisitions;
+    }
+
+    clh_handle_destroy(&clh_handle);
+
+    return NULL;
+}
+
+/*
+ * Returns 0 if lock has protected shared counter
+ */
+int bench_lock(lock_kind_t kind, int number_of_threads) {
+
+    lock_bench_t bench;
+    bench.kind = kind;
+    mcs_lock_init(&bench.mcs);
+    clh_lock_init(&bench.clh);
+    pthread_mutex_init(&bench.mutex, NULL);
+    atomic_init(&bench.is_running, true);
+    pthread_barrier_init(&bench.start_barrier, NULL, number_of_threads + 1);
+    bench.shared_counter = 0;
+
+    pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+    lock_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+    for (int i = 0; i < number_of_threads; ++i) {
+        inputs[i].bench = &bench;
+        inputs[i].acquisitions = 0;
+        pthread_create(thread_ids + i, NULL, lock_worker, inputs + i);
+    }
+
+    pthread_barrier_wait(&bench.start_barrier);
+
+    struct timespec duration = { 0, BENCH_DURATION_NS };
+    nanosleep(&duration, NULL);
+
+    atomic_store(&bench.is_running, false);
+
+    long acquisitions = 0;
+    for (int i = 0; i < number_of_threads; ++i) {
+        pthread_join(thread_ids[i], NULL);
+        acquisitions += inputs[i].acquisitions;
+    }
+
+    printf("%-14s threads=%2d: %8.2f M acquisitions/s\n",
+           LOCK_NAMES[kind], number_of_threads, acquisitions / (BENCH_DURATION_NS * 1e-9) * 1e-6);
+
+    pthread_barrier_destroy(&bench.start_barrier);
+    pthread_mutex_destroy(&bench.mutex);
+    clh_lock_destroy(&bench.clh);
+
+    return bench.shared_counter == acquisitions ? 0 : 1;
+}
+
+int main() {
+
+    int result = 0;
+
+    for (int kind = MCS_LOCK; kind <= PTHREAD_MUTEX; ++kind) {
+        for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+            result |= bench_lock(kind, n);
+        }
+    }
+
+    printf(result ? "Failure\n" : "Success\n");
+
+    return result;
+}
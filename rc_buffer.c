@@ -0,0 +1,245 @@
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ST_REF_COUNTER_
+#define ST_REF_COUNTER_
+#include "ref_counter.h"
+#endif
+
+#ifndef ST_RC_BUFFER_
+#define ST_RC_BUFFER_
+#include "rc_buffer.h"
+#endif
+
+#define RC_ROPE_INITIAL_CAPACITY 8
+
+
+static const RC_view_t RC_EMPTY_VIEW = { NULL, 0, 0 };
+
+
+/**
+ * @function creates buffer with a copy of bytes
+ * @brief    This is the only copy, all later views share it
+ * @returns  view of the whole buffer or empty view if error
+ */
+RC_view_t RC_buffer_from_bytes(const void *bytes, size_t size) {
+
+  RC_buffer_t *buffer = (RC_buffer_t*) RC_new(sizeof(RC_buffer_t) + size, NULL);
+
+  if (!buffer) {
+    return RC_EMPTY_VIEW;
+  }
+
+  buffer->size = size;
+  memcpy(buffer->bytes, bytes, size);
+
+  RC_view_t result = { buffer, 0, size };
+
+  return result;
+}
+
+
+/**
+ * @function creates view of view's bytes, range is clamped to the view
+ * @returns  new view sharing the same buffer
+ */
+RC_view_t RC_view_slice(RC_view_t *view, size_t offset, size_t length) {
+
+  if (!view->buffer || offset >= view->length) {
+    return RC_EMPTY_VIEW;
+  }
+
+  if (length > view->length - offset) {
+    length = view->length - offset;
+  }
+
+  RC_data_incref(view->buffer);
+
+  RC_view_t result = { view->buffer, view->offset + offset, length };
+
+  return result;
+}
+
+
+/**
+ * @function creates another view of the same bytes
+ */
+RC_view_t RC_view_clone(RC_view_t *view) {
+
+  if (view->buffer) {
+    RC_data_incref(view->buffer);
+  }
+
+  return *view;
+}
+
+
+/**
+ * @function releases view's reference to buffer and empties view
+ */
+void RC_view_release(RC_view_t *view) {
+
+  if (view->buffer) {
+    RC_data_decref(view->buffer);
+  }
+
+  *view = RC_EMPTY_VIEW;
+}
+
+
+/**
+ * @function inits empty rope
+ * @returns  pointer to the created rope or NULL if error
+ */
+RC_rope_t *init_RC_rope() {
+
+  RC_rope_t *rope = (RC_rope_t*) malloc(sizeof(RC_rope_t));
+
+  if (!rope) {
+    return NULL;
+  }
+
+  rope->views = NULL;
+  rope->size = 0;
+  rope->capacity = 0;
+  rope->length = 0;
+
+  return rope;
+}
+
+
+/**
+ * @function releases all rope's views and frees its memory
+ */
+void close_RC_rope(RC_rope_t *rope) {
+
+  for (unsigned int i = 0; i < rope->size; ++i) {
+    RC_view_release(rope->views + i);
+  }
+
+  free(rope->views);
+  free(rope);
+}
+
+
+/**
+ * @function appends view without taking a reference
+ * @returns  0 on success, -1 if error
+ */
+static int RC_rope_push(RC_rope_t *rope, RC_view_t view) {
+
+  if (rope->size == rope->capacity) {
+
+    unsigned int new_capacity = rope->capacity ? rope->capacity * 2 : RC_ROPE_INITIAL_CAPACITY;
+    RC_view_t *new_views = (RC_view_t*) realloc(rope->views, sizeof(RC_view_t) * new_capacity);
+
+    if (!new_views) {
+      return -1;
+    }
+
+    rope->views = new_views;
+    rope->capacity = new_capacity;
+  }
+
+  rope->views[rope->size++] = view;
+  rope->length += view.length;
+
+  return 0;
+}
+
+
+/**
+ * @function appends view's bytes to the end of rope
+ * @brief    Rope takes its own reference, caller keeps the view
+ * @returns  0 on success, -1 if error
+ */
+int RC_rope_append(RC_rope_t *rope, RC_view_t *view) {
+
+  if (!view->length) {
+    return 0;
+  }
+
+  RC_view_t clone = RC_view_clone(view);
+
+  if (RC_rope_push(rope, clone)) {
+    RC_view_release(&clone);
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * @function appends all views of other rope to the end of rope
+ * @returns  0 on success, -1 if error
+ */
+int RC_rope_concat(RC_rope_t *rope, RC_rope_t *other_rope) {
+
+  // other_rope may be the same rope, so its size is fixed first
+  unsigned int other_size = other_rope->size;
+
+  for (unsigned int i = 0; i < other_size; ++i) {
+    if (RC_rope_append(rope, other_rope->views + i)) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+/**
+ * @function creates rope of rope's byte range, range is clamped to the rope
+ * @returns  pointer to the created rope or NULL if error
+ */
+RC_rope_t *RC_rope_slice(RC_rope_t *rope, size_t offset, size_t length) {
+
+  RC_rope_t *result = init_RC_rope();
+
+  if (!result) {
+    return NULL;
+  }
+
+  for (unsigned int i = 0; i < rope->size && length; ++i) {
+
+    RC_view_t *view = rope->views + i;
+
+    if (offset >= view->length) {
+      offset -= view->length;
+      continue;
+    }
+
+    RC_view_t slice = RC_view_slice(view, offset, length);
+
+    if (RC_rope_push(result, slice)) {
+      RC_view_release(&slice);
+      close_RC_rope(result);
+      return NULL;
+    }
+
+    length -= slice.length;
+    offset = 0;
+  }
+
+  return result;
+}
+
+
+/**
+ * @function exports rope for scatter-gather output (writev, sendmsg)
+ * @brief    iov entries point into buffers, rope should outlive the call
+ * @returns  number of filled entries, at most max_iov
+ */
+int RC_rope_to_iovec(RC_rope_t *rope, struct iovec *iov, int max_iov) {
+
+  int filled_counter = 0;
+
+  for (unsigned int i = 0; i < rope->size && filled_counter < max_iov; ++i) {
+    iov[filled_counter].iov_base = (void*) RC_view_data(rope->views + i);
+    iov[filled_counter].iov_len = rope->views[i].length;
+    ++filled_counter;
+  }
+
+  return filled_counter;
+}
@@ -0,0 +1,85 @@
+#include <stddef.h>
+#include <sys/uio.h>
+
+
+/**
+ * @struct immutable refcounted byte buffer
+ * @brief  Allocated by RC_new, so it carries RC_object_t header
+ *         and is shared by all views created from it
+ */
+typedef struct {
+  size_t size;
+  char bytes[];
+} RC_buffer_t;
+
+
+/**
+ * @struct view of buffer's bytes
+ * @brief  Each view holds a reference to its buffer,
+ *         buffer is freed when last view is released
+ *
+ * @prop {buffer} shared buffer, NULL for empty view
+ * @prop {offset} view start in buffer
+ * @prop {length} number of bytes in view
+ */
+typedef struct {
+  RC_buffer_t *buffer;
+  size_t offset;
+  size_t length;
+} RC_view_t;
+
+
+/**
+ * @struct rope of views, concatenation without copying bytes
+ */
+typedef struct {
+  RC_view_t *views;
+  unsigned int size;
+  unsigned int capacity;
+  size_t length;
+} RC_rope_t;
+
+
+RC_view_t RC_buffer_from_bytes(const void *bytes, size_t size);
+
+
+RC_view_t RC_view_slice(RC_view_t *view, size_t offset, size_t length);
+
+
+RC_view_t RC_view_clone(RC_view_t *view);
+
+
+void RC_view_release(RC_view_t *view);
+
+
+RC_rope_t *init_RC_rope();
+
+
+void close_RC_rope(RC_rope_t *rope);
+
+
+int RC_rope_append(RC_rope_t *rope, RC_view_t *view);
+
+
+int RC_rope_concat(RC_rope_t *rope, RC_rope_t *other_rope);
+
+
+RC_rope_t *RC_rope_slice(RC_rope_t *rope, size_t offset, size_t length);
+
+
+int RC_rope_to_iovec(RC_rope_t *rope, struct iovec *iov, int max_iov);
+
+
+static inline const char *RC_view_data(RC_view_t *view) {
+  return view->buffer ? view->buffer->bytes + view->offset : NULL;
+}
+
+
+static inline size_t RC_view_length(RC_view_t *view) {
+  return view->length;
+}
+
+
+static inline size_t RC_rope_length(RC_rope_t *rope) {
+  return rope->length;
+}
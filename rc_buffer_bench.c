@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef ST_REF_COUNTER_
+#define ST_REF_COUNTER_
+#include "ref_counter.h"
+#endif
+
+#ifndef ST_RC_BUFFER_
+#define ST_RC_BUFFER_
+#include "rc_buffer.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int PIPELINE_ITERATIONS = 1000000;
+const int PIPELINE_STAGES = 4;
+const int PAYLOAD_SIZE = 4096;
+const int STAGE_HEADER_SIZE = 16;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+/**
+ * @function slices fields of two payloads, joins them with rope and sends with writev
+ * @returns  0 if bytes read back from pipe are the expected ones
+ */
+int test_rope_writev() {
+
+  const char *first_payload = "GET /index.html HTTP/1.1";
+  const char *second_payload = "Host: example.com";
+  const char *expected = "/index.html example.com";
+
+  RC_view_t first = RC_buffer_from_bytes(first_payload, strlen(first_payload));
+  RC_view_t second = RC_buffer_from_bytes(second_payload, strlen(second_payload));
+
+  RC_view_t path = RC_view_slice(&first, 4, 11);
+  RC_view_t space = RC_view_slice(&first, 3, 1);
+  RC_view_t host = RC_view_slice(&second, 6, 100); // clamped to the end
+
+  // buffers stay alive through slices only
+  RC_view_release(&first);
+  RC_view_release(&second);
+
+  RC_rope_t *rope = init_RC_rope();
+  RC_rope_append(rope, &path);
+  RC_rope_append(rope, &space);
+
+  RC_rope_t *tail_rope = init_RC_rope();
+  RC_rope_append(tail_rope, &host);
+  RC_rope_concat(rope, tail_rope);
+  close_RC_rope(tail_rope);
+
+  RC_view_release(&path);
+  RC_view_release(&space);
+  RC_view_release(&host);
+
+  // "index" from the middle of first view
+  RC_rope_t *sliced_rope = RC_rope_slice(rope, 1, 5);
+
+  int pipe_fds[2];
+  pipe(pipe_fds);
+
+  struct iovec iov[8];
+  int iov_count = RC_rope_to_iovec(rope, iov, 8);
+  writev(pipe_fds[1], iov, iov_count);
+
+  iov_count = RC_rope_to_iovec(sliced_rope, iov, 8);
+  writev(pipe_fds[1], iov, iov_count);
+
+  char read_bytes[64] = { 0 };
+  size_t expected_size = strlen(expected) + 5;
+  read(pipe_fds[0], read_bytes, expected_size);
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+
+  int is_equal = RC_rope_length(rope) == strlen(expected) &&
+                 memcmp(read_bytes, expected, strlen(expected)) == 0 &&
+                 memcmp(read_bytes + strlen(expected), "index", 5) == 0;
+
+  close_RC_rope(sliced_rope);
+  close_RC_rope(rope);
+
+  if (!is_equal) {
+    printf("test_rope_writev: Failure. Read = %s\n", read_bytes);
+    return 1;
+  }
+
+  printf("test_rope_writev: Success\n");
+
+  return 0;
+}
+
+
+/**
+ * @function each pipeline stage strips its header, by copying and by slicing
+ */
+void bench_pipeline() {
+
+  char *payload = (char*) malloc(PAYLOAD_SIZE);
+  memset(payload, 'x', PAYLOAD_SIZE);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < PIPELINE_ITERATIONS; ++i) {
+
+    size_t size = PAYLOAD_SIZE;
+    char *current = (char*) malloc(size);
+    memcpy(current, payload, size);
+
+    for (int stage = 0; stage < PIPELINE_STAGES; ++stage) {
+      size -= STAGE_HEADER_SIZE;
+      char *next = (char*) malloc(size);
+      memcpy(next, current + STAGE_HEADER_SIZE, size);
+      free(current);
+      current = next;
+    }
+
+    free(current);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("copying stages: %8.2f ns/payload\n",
+         get_time_diff_sec(&start, &end) / PIPELINE_ITERATIONS * 1e9);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < PIPELINE_ITERATIONS; ++i) {
+
+    RC_view_t current = RC_buffer_from_bytes(payload, PAYLOAD_SIZE);
+
+    for (int stage = 0; stage < PIPELINE_STAGES; ++stage) {
+      RC_view_t next = RC_view_slice(&current, STAGE_HEADER_SIZE, current.length);
+      RC_view_release(&current);
+      current = next;
+    }
+
+    RC_view_release(&current);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("slicing stages: %8.2f ns/payload\n",
+         get_time_diff_sec(&start, &end) / PIPELINE_ITERATIONS * 1e9);
+
+  free(payload);
+}
+
+
+int main() {
+
+  int result = test_rope_writev();
+
+  bench_pipeline();
+
+  return result;
+}
@@ -1,20 +1,13 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
 
-
-typedef void (*RC_destructor_t)(void*);
-
-
-typedef struct  {
-  void *data;
-  RC_destructor_t dealloc;
-} RC_payload_t;
-
-
-typedef struct {
-  uint ref_count;
-  RC_payload_t payload;
-} RC_object_t;
+#ifndef ST_REF_COUNTER_
+#define ST_REF_COUNTER_
+#include "ref_counter.h"
+#endif
 
 
 /**
@@ -37,71 +30,414 @@ RC_payload_t *init_RC_payload(void *data, RC_destructor_t dealloc) {
 
 /**
  * @function RC_object_t constructor
+ * @brief    Payload is copied into the object and its memory is freed.
+ *           On error payload memory is freed too, data is left to caller
  */
 RC_object_t *init_RC_object(RC_payload_t *payload) {
 
   RC_object_t *result = (RC_object_t*) malloc(sizeof(RC_object_t));
 
   if (!result) {
+    free(payload);
     return NULL;
   }
 
-  result->ref_count = 1;
+  RC_count_init(&result->ref_count, 1);
   result->payload = *payload;
+  result->deferred_next = NULL;
+
+  free(payload);
 
   return result;
 }
 
 
 /**
- * Deallocs holded memory
+ * @function allocates refcounted object with inline data
+ * @brief    Header, destructor and data share one allocation, objects
+ *           larger than a cache line start on cache line boundary,
+ *           so header and first bytes of data are fetched together.
+ *           Destructor (may be NULL) should only release
+ *           resources holded by data, memory itself is freed by RC_dealloc
+ * @returns  pointer to data or NULL if error
+ */
+void *RC_new(size_t size, RC_destructor_t dtor) {
+
+  size_t alloc_size = RC_INLINE_HEADER_SIZE + size;
+  RC_object_t *result;
+
+  if (alloc_size <= RC_CACHE_LINE_SIZE) {
+    // small objects: aligned_alloc bypasses malloc's per-thread
+    // caches and costs more than the line it could save
+    result = (RC_object_t*) malloc(alloc_size);
+  } else {
+    // aligned_alloc requires size to be multiple of alignment
+    alloc_size = (alloc_size + RC_CACHE_LINE_SIZE - 1) & ~(size_t) (RC_CACHE_LINE_SIZE - 1);
+    result = (RC_object_t*) aligned_alloc(RC_CACHE_LINE_SIZE, alloc_size);
+  }
+
+  if (!result) {
+    return NULL;
+  }
+
+  void *data = (char*) result + RC_INLINE_HEADER_SIZE;
+
+  RC_count_init(&result->ref_count, 1);
+  result->payload.data = data;
+  result->payload.dealloc = dtor;
+  result->deferred_next = NULL;
+
+  return data;
+}
+
+
+/**
+ * Deallocs holded memory and object itself
  */
 void RC_dealloc(RC_object_t *obj) {
   RC_destructor_t dealloc = obj->payload.dealloc;
-  (*dealloc)(obj->payload.data);
+
+  if (dealloc) {
+    (*dealloc)(obj->payload.data);
+  }
+
+  free(obj);
 }
 
 
 /**
- * @function increases number of references without NULL-check
+ * @struct FIFO of objects, whose destruction was deferred
  */
-static inline void RC_incref(RC_object_t *obj) {
-  obj->ref_count++;
-}
+typedef struct {
+  RC_object_t *head;
+  RC_object_t *tail;
+} RC_deferred_queue_t;
+
+
+// Objects released by RC_decref_deferred in the current thread
+static _Thread_local RC_deferred_queue_t RC_deferred_local_queue;
 
 
 /**
- * @function increases number of references WITH NULL-check
+ * @function queues object with zero references for later destruction
  */
-static inline void RC_xincref(RC_object_t *obj) {
-  if (obj != NULL) {
-    RC_incref(obj);
+void RC_defer_dealloc(RC_object_t *obj) {
+
+  RC_deferred_queue_t *queue = &RC_deferred_local_queue;
+
+  obj->deferred_next = NULL;
+
+  if (queue->tail) {
+    queue->tail->deferred_next = obj;
+  } else {
+    queue->head = obj;
   }
+
+  queue->tail = obj;
 }
 
 
 /**
- * @function decreases number of references without NULL-check
+ * @function destroys at most max_objects queued objects of the calling thread
+ * @brief    Should be called at safe points. Destructors may defer more
+ *           objects, they are appended to the queue and destroyed by
+ *           following calls, so the work per call stays bounded
+ * @returns  number of destroyed objects
  */
-static inline void RC_decref(RC_object_t *obj) {
-  if (--obj->ref_count == 0) {
+int RC_drain_deferred(int max_objects) {
+
+  RC_deferred_queue_t *queue = &RC_deferred_local_queue;
+  int destroyed_counter = 0;
+
+  while (queue->head && destroyed_counter < max_objects) {
+
+    RC_object_t *obj = queue->head;
+
+    queue->head = obj->deferred_next;
+    if (!queue->head) {
+      queue->tail = NULL;
+    }
+
     RC_dealloc(obj);
+    ++destroyed_counter;
+  }
+
+  return destroyed_counter;
+}
+
+
+#ifndef RC_SINGLE_THREADED
+
+
+// Chains of objects handed over to reclaimer thread
+static _Atomic(RC_object_t*) RC_reclaimer_head = NULL;
+
+static pthread_t RC_reclaimer_thread;
+static atomic_bool RC_is_reclaimer_running = false;
+
+
+typedef struct {
+  int batch_size;
+  unsigned int idle_sleep_us;
+} RC_reclaimer_input_t;
+
+
+/**
+ * @function hands all queued objects of the calling thread to reclaimer
+ * @brief    Costs a single CAS regardless of queue length
+ */
+void RC_publish_deferred() {
+
+  RC_deferred_queue_t *queue = &RC_deferred_local_queue;
+
+  if (!queue->head) {
+    return;
   }
+
+  RC_object_t *old_head = atomic_load_explicit(&RC_reclaimer_head, memory_order_relaxed);
+
+  do {
+    queue->tail->deferred_next = old_head;
+  } while (!atomic_compare_exchange_weak_explicit(&RC_reclaimer_head, &old_head, queue->head,
+                                                  memory_order_release, memory_order_relaxed));
+
+  queue->head = NULL;
+  queue->tail = NULL;
 }
 
 
 /**
- * @function decreases number of references WITH NULL-check
+ * @function appends chain of objects to the queue of the calling thread
  */
-static inline void RC_xdecref(RC_object_t *obj) {
-  if (obj != NULL) {
-    RC_decref(obj);
+static void RC_append_deferred_chain(RC_object_t *chain) {
+
+  while (chain) {
+    RC_object_t *next_obj = chain->deferred_next;
+    RC_defer_dealloc(chain);
+    chain = next_obj;
   }
 }
 
 
-int main() {
+/**
+ * @function reclaimer thread routine
+ */
+static void *RC_reclaimer_worker(void *data) {
 
+  RC_reclaimer_input_t input = *((RC_reclaimer_input_t*) data);
+  free(data);
+
+  while (atomic_load_explicit(&RC_is_reclaimer_running, memory_order_relaxed)) {
+
+    RC_object_t *chain = atomic_exchange_explicit(&RC_reclaimer_head, NULL, memory_order_acquire);
+    RC_append_deferred_chain(chain);
+
+    if (!RC_drain_deferred(input.batch_size)) {
+      usleep(input.idle_sleep_us);
+    }
+  }
+
+  // destroy everything, that was published before stop
+  RC_append_deferred_chain(atomic_exchange_explicit(&RC_reclaimer_head, NULL, memory_order_acquire));
+  while (RC_drain_deferred(input.batch_size));
+
+  return NULL;
+}
+
+
+/**
+ * @function starts background thread, that destroys published objects
+ * @returns  0 on success, -1 if error or reclaimer is already running
+ */
+int RC_start_reclaimer(int batch_size, unsigned int idle_sleep_us) {
+
+  if (atomic_exchange(&RC_is_reclaimer_running, true)) {
+    return -1;
+  }
+
+  RC_reclaimer_input_t *input = (RC_reclaimer_input_t*) malloc(sizeof(RC_reclaimer_input_t));
+
+  if (!input) {
+    atomic_store(&RC_is_reclaimer_running, false);
+    return -1;
+  }
+
+  input->batch_size = batch_size;
+  input->idle_sleep_us = idle_sleep_us;
+
+  if (pthread_create(&RC_reclaimer_thread, NULL, RC_reclaimer_worker, input)) {
+    free(input);
+    atomic_store(&RC_is_reclaimer_running, false);
+    return -1;
+  }
 
   return 0;
 }
+
+
+/**
+ * @function stops reclaimer thread after it destroys all published objects
+ */
+void RC_stop_reclaimer() {
+
+  if (!atomic_exchange(&RC_is_reclaimer_running, false)) {
+    return;
+  }
+
+  pthread_join(RC_reclaimer_thread, NULL);
+}
+
+
+_Thread_local RC_biased_queue_t RC_biased_local_queue;
+
+
+static inline long RC_biased_get_count(long shared_count) {
+  return shared_count >> RC_BIASED_COUNT_SHIFT;
+}
+
+
+/**
+ * @function biased object constructor, calling thread becomes owner
+ * @brief    Payload is copied into the object and its memory is freed.
+ *           On error payload memory is freed too, data is left to caller
+ */
+RC_biased_object_t *init_RC_biased_object(RC_payload_t *payload) {
+
+  RC_biased_object_t *result = (RC_biased_object_t*) malloc(sizeof(RC_biased_object_t));
+
+  if (!result) {
+    free(payload);
+    return NULL;
+  }
+
+  result->owner_queue = &RC_biased_local_queue;
+  result->biased_count = 1;
+  result->is_merged = 0;
+  atomic_init(&result->shared_count, 0);
+  result->queue_next = NULL;
+  result->payload = *payload;
+
+  free(payload);
+
+  return result;
+}
+
+
+/**
+ * Deallocs holded memory and biased object itself
+ */
+void RC_biased_dealloc(RC_biased_object_t *obj) {
+  RC_destructor_t dealloc = obj->payload.dealloc;
+
+  if (dealloc) {
+    (*dealloc)(obj->payload.data);
+  }
+
+  free(obj);
+}
+
+
+/**
+ * @function moves owner's references into shared counter
+ * @brief    After merge all threads including owner use shared counter.
+ *           Object is freed here if no references left and it is not
+ *           waiting in owner's queue, otherwise queue processing frees it
+ * @alert    should be called only by owner thread
+ */
+void RC_biased_merge(RC_biased_object_t *obj) {
+
+  long biased = (long) obj->biased_count << RC_BIASED_COUNT_SHIFT;
+  long old_shared = atomic_load_explicit(&obj->shared_count, memory_order_relaxed);
+  long new_shared;
+
+  // once merged flag is published, other thread may free the object
+  obj->biased_count = 0;
+  obj->is_merged = 1;
+
+  do {
+    new_shared = (old_shared + biased) | RC_BIASED_MERGED_FLAG;
+  } while (!atomic_compare_exchange_weak_explicit(&obj->shared_count, &old_shared, new_shared,
+                                                  memory_order_acq_rel, memory_order_relaxed));
+
+  if (RC_biased_get_count(new_shared) == 0 && !(new_shared & RC_BIASED_QUEUED_FLAG)) {
+    RC_biased_dealloc(obj);
+  }
+}
+
+
+/**
+ * @function decreases shared counter, used by non-owner threads
+ * @brief    Queues object to owner once shared counter goes negative,
+ *           because only owner knows if references are really gone
+ */
+void RC_biased_shared_decref(RC_biased_object_t *obj) {
+
+  long old_shared = atomic_load_explicit(&obj->shared_count, memory_order_relaxed);
+  long new_shared;
+
+  do {
+    new_shared = old_shared - RC_BIASED_COUNT_ONE;
+
+    if (RC_biased_get_count(new_shared) < 0 && !(new_shared & RC_BIASED_FLAGS_MASK)) {
+      new_shared |= RC_BIASED_QUEUED_FLAG;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&obj->shared_count, &old_shared, new_shared,
+                                                  memory_order_release, memory_order_relaxed));
+
+  // this thread has set the flag
+  if ((new_shared & RC_BIASED_QUEUED_FLAG) && !(old_shared & RC_BIASED_QUEUED_FLAG)) {
+
+    RC_biased_queue_t *queue = obj->owner_queue;
+    obj->queue_next = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    while (!atomic_compare_exchange_weak_explicit(&queue->head, &obj->queue_next, obj,
+                                                  memory_order_release, memory_order_relaxed));
+    return;
+  }
+
+  if (RC_biased_get_count(new_shared) == 0 && (new_shared & RC_BIASED_FLAGS_MASK) == RC_BIASED_MERGED_FLAG) {
+    atomic_thread_fence(memory_order_acquire);
+    RC_biased_dealloc(obj);
+  }
+}
+
+
+/**
+ * @function merges objects queued to the calling thread
+ * @brief    Owner thread should call it at safe points and before exit,
+ *           otherwise objects released by other threads are never freed
+ * @returns  number of processed objects
+ */
+int RC_biased_process_queue() {
+
+  int processed_counter = 0;
+  RC_biased_object_t *obj = atomic_exchange_explicit(&RC_biased_local_queue.head, NULL, memory_order_acquire);
+
+  while (obj) {
+
+    RC_biased_object_t *next_obj = obj->queue_next;
+
+    long biased = (long) obj->biased_count << RC_BIASED_COUNT_SHIFT;
+    long old_shared = atomic_load_explicit(&obj->shared_count, memory_order_relaxed);
+    long new_shared;
+
+    obj->biased_count = 0;
+    obj->is_merged = 1;
+
+    do {
+      new_shared = ((old_shared + biased) | RC_BIASED_MERGED_FLAG) & ~RC_BIASED_QUEUED_FLAG;
+    } while (!atomic_compare_exchange_weak_explicit(&obj->shared_count, &old_shared, new_shared,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+
+    if (RC_biased_get_count(new_shared) == 0) {
+      RC_biased_dealloc(obj);
+    }
+
+    obj = next_obj;
+    ++processed_counter;
+  }
+
+  return processed_counter;
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include <stdatomic.h>
+#include <stddef.h>
+
+
+/*
+ * Reference counting mode is selected at compile time:
+ *
+ *   default            - counters are C11 atomics, objects may be
+ *                        shared between threads
+ *   RC_SINGLE_THREADED - counters are plain integers, objects must
+ *                        not escape the thread that created them
+ */
+#ifdef RC_SINGLE_THREADED
+typedef unsigned int RC_count_t;
+#else
+typedef _Atomic unsigned int RC_count_t;
+#endif
+
+
+typedef void (*RC_destructor_t)(void*);
+
+
+typedef struct  {
+  void *data;
+  RC_destructor_t dealloc;
+} RC_payload_t;
+
+
+typedef struct RC_object_t_ {
+  RC_count_t ref_count;
+  RC_payload_t payload;
+
+  // link in deferred destruction queue, see RC_decref_deferred
+  struct RC_object_t_ *deferred_next;
+} RC_object_t;
+
+
+#define RC_CACHE_LINE_SIZE 64
+
+// Inline objects keep header right before user data,
+// header is padded to keep data maximally aligned
+#define RC_INLINE_HEADER_SIZE \
+  ((sizeof(RC_object_t) + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1))
+
+
+RC_payload_t *init_RC_payload(void *data, RC_destructor_t dealloc);
+
+
+RC_object_t *init_RC_object(RC_payload_t *payload);
+
+
+void *RC_new(size_t size, RC_destructor_t dtor);
+
+
+void RC_dealloc(RC_object_t *obj);
+
+
+void RC_defer_dealloc(RC_object_t *obj);
+
+
+int RC_drain_deferred(int max_objects);
+
+
+#ifndef RC_SINGLE_THREADED
+
+void RC_publish_deferred();
+
+
+int RC_start_reclaimer(int batch_size, unsigned int idle_sleep_us);
+
+
+void RC_stop_reclaimer();
+
+#endif
+
+
+/**
+ * @function sets initial value of counter
+ */
+static inline void RC_count_init(RC_count_t *count, unsigned int value) {
+#ifdef RC_SINGLE_THREADED
+  *count = value;
+#else
+  atomic_init(count, value);
+#endif
+}
+
+
+/**
+ * @function reads current value of counter
+ * @alert    value may be stale as soon as it is returned
+ */
+static inline unsigned int RC_count_get(RC_count_t *count) {
+#ifdef RC_SINGLE_THREADED
+  return *count;
+#else
+  return atomic_load_explicit(count, memory_order_relaxed);
+#endif
+}
+
+
+/**
+ * @function increments counter
+ * @brief    A new reference can only be created from an existing one,
+ *           so no ordering is required here
+ */
+static inline void RC_count_inc(RC_count_t *count) {
+#ifdef RC_SINGLE_THREADED
+  ++*count;
+#else
+  atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+#endif
+}
+
+
+/**
+ * @function decrements counter
+ * @brief    Release on decrement publishes all writes made through
+ *           the dropped reference, acquire fence on zero makes them
+ *           visible to the thread, that is going to destroy the object
+ * @returns  1 if counter dropped to zero, 0 otherwise
+ */
+static inline int RC_count_dec(RC_count_t *count) {
+#ifdef RC_SINGLE_THREADED
+  return --*count == 0;
+#else
+  if (atomic_fetch_sub_explicit(count, 1, memory_order_release) == 1) {
+    atomic_thread_fence(memory_order_acquire);
+    return 1;
+  }
+  return 0;
+#endif
+}
+
+
+/**
+ * @function increases number of references without NULL-check
+ */
+static inline void RC_incref(RC_object_t *obj) {
+  RC_count_inc(&obj->ref_count);
+}
+
+
+/**
+ * @function increases number of references WITH NULL-check
+ */
+static inline void RC_xincref(RC_object_t *obj) {
+  if (obj != NULL) {
+    RC_incref(obj);
+  }
+}
+
+
+/**
+ * @function decreases number of references without NULL-check
+ */
+static inline void RC_decref(RC_object_t *obj) {
+  if (RC_count_dec(&obj->ref_count)) {
+    RC_dealloc(obj);
+  }
+}
+
+
+/**
+ * @function decreases number of references WITH NULL-check
+ */
+static inline void RC_xdecref(RC_object_t *obj) {
+  if (obj != NULL) {
+    RC_decref(obj);
+  }
+}
+
+
+/**
+ * @function decreases number of references without NULL-check
+ * @brief    Object is not destroyed in place, but queued to the calling
+ *           thread, see RC_drain_deferred and RC_publish_deferred
+ */
+static inline void RC_decref_deferred(RC_object_t *obj) {
+  if (RC_count_dec(&obj->ref_count)) {
+    RC_defer_dealloc(obj);
+  }
+}
+
+
+/**
+ * @function decreases number of references WITH NULL-check
+ * @brief    Object is not destroyed in place, see RC_decref_deferred
+ */
+static inline void RC_xdecref_deferred(RC_object_t *obj) {
+  if (obj != NULL) {
+    RC_decref_deferred(obj);
+  }
+}
+
+
+/**
+ * @function recovers object header from data pointer returned by RC_new
+ */
+static inline RC_object_t *RC_get_object(void *data) {
+  return (RC_object_t*) ((char*) data - RC_INLINE_HEADER_SIZE);
+}
+
+
+/**
+ * @function increases number of references to data created by RC_new
+ */
+static inline void RC_data_incref(void *data) {
+  RC_incref(RC_get_object(data));
+}
+
+
+/**
+ * @function decreases number of references to data created by RC_new
+ */
+static inline void RC_data_decref(void *data) {
+  RC_decref(RC_get_object(data));
+}
+
+
+/**
+ * @function deferred decref of data created by RC_new
+ */
+static inline void RC_data_decref_deferred(void *data) {
+  RC_decref_deferred(RC_get_object(data));
+}
+
+
+#ifndef RC_SINGLE_THREADED
+
+/*
+ * Biased reference counting
+ *
+ * Object is biased toward the thread, that created it. Owner thread
+ * counts its references in plain biased_count, all other threads
+ * count theirs in atomic shared_count. Sum of both is the real number
+ * of references.
+ *
+ * Shared counter holds number of references shifted by two bits,
+ * lower bits are flags:
+ *   MERGED - owner dropped its counter, shared counter is the only one
+ *   QUEUED - shared counter went negative, object waits in owner's
+ *            queue for explicit merge (see RC_biased_process_queue)
+ */
+#define RC_BIASED_MERGED_FLAG 1L
+#define RC_BIASED_QUEUED_FLAG 2L
+#define RC_BIASED_FLAGS_MASK  3L
+#define RC_BIASED_COUNT_SHIFT 2
+#define RC_BIASED_COUNT_ONE   (1L << RC_BIASED_COUNT_SHIFT)
+
+
+struct RC_biased_object_t_;
+
+
+/**
+ * @struct queue of objects, that should be merged by owner thread
+ */
+typedef struct {
+  _Atomic(struct RC_biased_object_t_*) head;
+} RC_biased_queue_t;
+
+
+typedef struct RC_biased_object_t_ {
+
+  // Owner fields, never touched by other threads
+  RC_biased_queue_t *owner_queue;
+  unsigned int biased_count;
+  int is_merged;
+
+  _Atomic long shared_count;
+
+  // link in owner's queue
+  struct RC_biased_object_t_ *queue_next;
+
+  RC_payload_t payload;
+
+} RC_biased_object_t;
+
+
+// Each thread owns queue, its address identifies owner thread
+extern _Thread_local RC_biased_queue_t RC_biased_local_queue;
+
+
+RC_biased_object_t *init_RC_biased_object(RC_payload_t *payload);
+
+
+void RC_biased_dealloc(RC_biased_object_t *obj);
+
+
+void RC_biased_merge(RC_biased_object_t *obj);
+
+
+void RC_biased_shared_decref(RC_biased_object_t *obj);
+
+
+int RC_biased_process_queue();
+
+
+static inline int RC_biased_is_owned(RC_biased_object_t *obj) {
+  return obj->owner_queue == &RC_biased_local_queue && !obj->is_merged;
+}
+
+
+/**
+ * @function increases number of references to biased object
+ */
+static inline void RC_biased_incref(RC_biased_object_t *obj) {
+  if (RC_biased_is_owned(obj)) {
+    obj->biased_count++;
+  } else {
+    atomic_fetch_add_explicit(&obj->shared_count, RC_BIASED_COUNT_ONE, memory_order_relaxed);
+  }
+}
+
+
+/**
+ * @function decreases number of references to biased object
+ */
+static inline void RC_biased_decref(RC_biased_object_t *obj) {
+  if (RC_biased_is_owned(obj)) {
+    if (--obj->biased_count == 0) {
+      RC_biased_merge(obj);
+    }
+  } else {
+    RC_biased_shared_decref(obj);
+  }
+}
+
+#endif
@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_REF_COUNTER_
+#define ST_REF_COUNTER_
+#include "ref_counter.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int MAX_NUMBER_OF_THREADS = 32;
+const int EACH_THREAD_ITERATIONS = 1000000;
+
+
+typedef struct {
+  RC_object_t *obj;
+  pthread_barrier_t *start_barrier;
+} contention_worker_input_t;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void free_int_data(void *data) {
+  free(data);
+}
+
+
+void *contention_worker(void *_input) {
+
+  contention_worker_input_t *input = (contention_worker_input_t*) _input;
+
+  pthread_barrier_wait(input->start_barrier);
+
+  // every pair leaves object alive, because main thread holds a reference
+  for (int i = 0; i < EACH_THREAD_ITERATIONS; ++i) {
+    RC_incref(input->obj);
+    // keep compiler from folding the pair in single-threaded mode
+    __asm__ __volatile__("" ::: "memory");
+    RC_decref(input->obj);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @function runs incref/decref pairs on one object shared by all threads
+ * @returns  0 if reference counter is consistent after run
+ */
+int bench_shared_object(int number_of_threads) {
+
+  int *data = (int*) malloc(sizeof(int));
+  RC_payload_t *payload = init_RC_payload(data, free_int_data);
+  RC_object_t *obj = init_RC_object(payload);
+
+  pthread_barrier_t start_barrier;
+  pthread_barrier_init(&start_barrier, NULL, number_of_threads + 1);
+
+  contention_worker_input_t input = { obj, &start_barrier };
+  pthread_t *thread_ids = (pthread_t*) malloc(sizeof(pthread_t) * number_of_threads);
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    pthread_create(thread_ids + i, NULL, contention_worker, &input);
+  }
+
+  struct timespec start, end;
+
+  // workers are parked on barrier until main thread joins it
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_barrier_wait(&start_barrier);
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    pthread_join(*(thread_ids + i), NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double elapsed = get_time_diff_sec(&start, &end);
+  double total_ops = 2.0 * EACH_THREAD_ITERATIONS * number_of_threads;
+
+  printf("threads=%2d: %8.2f Mops/s, %6.2f ns/op\n",
+         number_of_threads, total_ops / elapsed * 1e-6, elapsed / total_ops * 1e9);
+
+  int is_consistent = RC_count_get(&obj->ref_count) == 1;
+
+  RC_decref(obj);
+  pthread_barrier_destroy(&start_barrier);
+  free(thread_ids);
+
+  return is_consistent ? 0 : 1;
+}
+
+
+/**
+ * @function compares create/destroy cost of payload objects and RC_new
+ */
+void bench_allocation() {
+
+  const int iterations = EACH_THREAD_ITERATIONS;
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < iterations; ++i) {
+    int *data = (int*) malloc(sizeof(int));
+    RC_object_t *obj = init_RC_object(init_RC_payload(data, free_int_data));
+    *((int*) obj->payload.data) = i;
+    RC_decref(obj);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("init_RC_object: %6.2f ns/object\n", get_time_diff_sec(&start, &end) / iterations * 1e9);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < iterations; ++i) {
+    int *data = (int*) RC_new(sizeof(int), NULL);
+    *data = i;
+    RC_data_decref(data);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("RC_new:         %6.2f ns/object\n", get_time_diff_sec(&start, &end) / iterations * 1e9);
+}
+
+
+#ifndef RC_SINGLE_THREADED
+
+typedef struct {
+  RC_biased_object_t *obj;
+  pthread_barrier_t *start_barrier;
+} biased_worker_input_t;
+
+
+void *biased_contention_worker(void *_input) {
+
+  biased_worker_input_t *input = (biased_worker_input_t*) _input;
+
+  pthread_barrier_wait(input->start_barrier);
+
+  for (int i = 0; i < EACH_THREAD_ITERATIONS; ++i) {
+    RC_biased_incref(input->obj);
+    __asm__ __volatile__("" ::: "memory");
+    RC_biased_decref(input->obj);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @function runs incref/decref pairs on biased object owned by main thread
+ * @brief    0 threads means owner-only workload, run by main thread itself
+ */
+void bench_biased_object(int number_of_threads) {
+
+  int *data = (int*) malloc(sizeof(int));
+  RC_biased_object_t *obj = init_RC_biased_object(init_RC_payload(data, free_int_data));
+
+  pthread_barrier_t start_barrier;
+  pthread_barrier_init(&start_barrier, NULL, number_of_threads + 1);
+
+  biased_worker_input_t input = { obj, &start_barrier };
+  pthread_t *thread_ids = (pthread_t*) malloc(sizeof(pthread_t) * (number_of_threads + 1));
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    pthread_create(thread_ids + i, NULL, biased_contention_worker, &input);
+  }
+
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  if (number_of_threads == 0) {
+    biased_contention_worker(&input);
+  } else {
+    pthread_barrier_wait(&start_barrier);
+  }
+
+  for (int i = 0; i < number_of_threads; ++i) {
+    pthread_join(*(thread_ids + i), NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  int workers = number_of_threads ? number_of_threads : 1;
+  double elapsed = get_time_diff_sec(&start, &end);
+  double total_ops = 2.0 * EACH_THREAD_ITERATIONS * workers;
+
+  printf("biased %s threads=%2d: %8.2f Mops/s, %6.2f ns/op\n",
+         number_of_threads ? "shared" : "owner ", workers,
+         total_ops / elapsed * 1e-6, elapsed / total_ops * 1e9);
+
+  RC_biased_decref(obj);
+  pthread_barrier_destroy(&start_barrier);
+  free(thread_ids);
+}
+
+
+static int is_transferred_object_freed = 0;
+
+
+static void mark_transferred_object_freed(void *data) {
+  (void) data;
+  is_transferred_object_freed = 1;
+}
+
+
+void *drop_transferred_reference(void *obj) {
+  RC_biased_decref((RC_biased_object_t*) obj);
+  return NULL;
+}
+
+
+/**
+ * @function checks merge protocol when reference escapes to other thread
+ * @returns  0 on success
+ */
+int test_biased_transfer() {
+
+  RC_biased_object_t *obj = init_RC_biased_object(init_RC_payload(NULL, mark_transferred_object_freed));
+
+  // reference is taken by owner and released by other thread,
+  // so shared counter goes negative and object is queued to owner
+  RC_biased_incref(obj);
+
+  pthread_t thread_id;
+  pthread_create(&thread_id, NULL, drop_transferred_reference, obj);
+  pthread_join(thread_id, NULL);
+
+  int processed = RC_biased_process_queue();
+
+  // owner still holds its own reference
+  int is_alive = !is_transferred_object_freed;
+
+  RC_biased_decref(obj);
+
+  if (processed != 1 || !is_alive || !is_transferred_object_freed) {
+    printf("test_biased_transfer: Failure\n");
+    return 1;
+  }
+
+  printf("test_biased_transfer: Success\n");
+
+  return 0;
+}
+
+
+const int MERGE_RACE_ROUNDS = 10000;
+
+static _Atomic int merge_race_objects_freed = 0;
+
+
+static void count_merge_race_object_freed(void *data) {
+  (void) data;
+  ++merge_race_objects_freed;
+}
+
+
+typedef struct {
+  RC_biased_object_t *obj;
+  pthread_barrier_t *round_barrier;
+} merge_race_input_t;
+
+
+void *drop_reference_after_merge(void *_input) {
+
+  merge_race_input_t *input = (merge_race_input_t*) _input;
+
+  for (int i = 0; i < MERGE_RACE_ROUNDS; ++i) {
+
+    // wait for new object, take shared reference
+    pthread_barrier_wait(input->round_barrier);
+    RC_biased_object_t *obj = input->obj;
+    RC_biased_incref(obj);
+
+    // owner merges and this thread drops the last reference concurrently
+    pthread_barrier_wait(input->round_barrier);
+    RC_biased_decref(obj);
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @function checks, that owner does not touch object after merge,
+ *           when other thread drops the last reference right after it
+ * @returns  0 if every object is freed exactly once
+ */
+int test_biased_merge_race() {
+
+  pthread_barrier_t round_barrier;
+  pthread_barrier_init(&round_barrier, NULL, 2);
+
+  merge_race_input_t input = { NULL, &round_barrier };
+  merge_race_objects_freed = 0;
+
+  pthread_t thread_id;
+  pthread_create(&thread_id, NULL, drop_reference_after_merge, &input);
+
+  for (int i = 0; i < MERGE_RACE_ROUNDS; ++i) {
+
+    input.obj = init_RC_biased_object(init_RC_payload(NULL, count_merge_race_object_freed));
+    RC_biased_object_t *obj = input.obj;
+
+    pthread_barrier_wait(&round_barrier);
+    pthread_barrier_wait(&round_barrier);
+
+    // owner's last reference, merges counters
+    RC_biased_decref(obj);
+  }
+
+  pthread_join(thread_id, NULL);
+  pthread_barrier_destroy(&round_barrier);
+
+  if (merge_race_objects_freed != MERGE_RACE_ROUNDS) {
+    printf("test_biased_merge_race: Failure\n");
+    return 1;
+  }
+
+  printf("test_biased_merge_race: Success\n");
+
+  return 0;
+}
+
+#endif
+
+
+const int GRAPH_SIZE = 10000;
+const int DEFERRED_BATCH_SIZE = 64;
+
+
+typedef struct {
+  void *child;
+} graph_node_t;
+
+
+static _Atomic int graph_nodes_freed = 0;
+
+
+static void free_graph_node(void *data) {
+  graph_node_t *node = (graph_node_t*) data;
+  if (node->child) {
+    RC_data_decref(node->child);
+  }
+  ++graph_nodes_freed;
+}
+
+
+static void free_graph_node_deferred(void *data) {
+  graph_node_t *node = (graph_node_t*) data;
+  if (node->child) {
+    RC_data_decref_deferred(node->child);
+  }
+  ++graph_nodes_freed;
+}
+
+
+/**
+ * @function builds chain of nodes, each node holds the only reference to the next one
+ * @returns  root node
+ */
+static graph_node_t *build_graph(RC_destructor_t dtor) {
+
+  graph_node_t *child = NULL;
+
+  for (int i = 0; i < GRAPH_SIZE; ++i) {
+    graph_node_t *node = (graph_node_t*) RC_new(sizeof(graph_node_t), dtor);
+    node->child = child;
+    child = node;
+  }
+
+  return child;
+}
+
+
+/**
+ * @function compares worst pause of dropping graph root inline and deferred
+ * @returns  0 if all nodes were destroyed in both modes
+ */
+int bench_deferred_decref() {
+
+  struct timespec start, end;
+  int result = 0;
+
+  graph_nodes_freed = 0;
+  graph_node_t *root = build_graph(free_graph_node);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  RC_data_decref(root);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  printf("inline decref:   pause %8.2f us\n", get_time_diff_sec(&start, &end) * 1e6);
+  result |= graph_nodes_freed != GRAPH_SIZE;
+
+  graph_nodes_freed = 0;
+  root = build_graph(free_graph_node_deferred);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  RC_data_decref_deferred(root);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double max_pause = get_time_diff_sec(&start, &end);
+  int number_of_calls = 0;
+
+  for (;;) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int destroyed = RC_drain_deferred(DEFERRED_BATCH_SIZE);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (!destroyed) {
+      break;
+    }
+
+    double pause = get_time_diff_sec(&start, &end);
+    max_pause = pause > max_pause ? pause : max_pause;
+    ++number_of_calls;
+  }
+
+  printf("deferred decref: pause %8.2f us (batch=%d, %d drain calls)\n",
+         max_pause * 1e6, DEFERRED_BATCH_SIZE, number_of_calls);
+  result |= graph_nodes_freed != GRAPH_SIZE;
+
+#ifndef RC_SINGLE_THREADED
+  graph_nodes_freed = 0;
+  root = build_graph(free_graph_node_deferred);
+
+  RC_start_reclaimer(DEFERRED_BATCH_SIZE, 100);
+  RC_data_decref_deferred(root);
+  RC_publish_deferred();
+  RC_stop_reclaimer();
+
+  printf("reclaimer thread: destroyed %d of %d nodes\n", graph_nodes_freed, GRAPH_SIZE);
+  result |= graph_nodes_freed != GRAPH_SIZE;
+#endif
+
+  return result;
+}
+
+
+int main() {
+
+  int result = 0;
+
+#ifdef RC_SINGLE_THREADED
+  printf("Mode: single-threaded\n");
+  // plain counter is not allowed to be shared
+  result |= bench_shared_object(1);
+#else
+  printf("Mode: atomic\n");
+  for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+    result |= bench_shared_object(n);
+  }
+
+  bench_biased_object(0);
+  for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+    bench_biased_object(n);
+  }
+
+  result |= test_biased_transfer();
+  result |= test_biased_merge_race();
+#endif
+
+  bench_allocation();
+
+  result |= bench_deferred_decref();
+
+  printf(result ? "Failure\n" : "Success\n");
+
+  return result;
+}
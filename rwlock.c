@@ -0,0 +1,238 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_RWLOCK_
+#define ST_RWLOCK_
+#include "rwlock.h"
+#endif
+
+#define RWLOCK_UNLOCKED 0
+#define RWLOCK_LOCKED 1
+#define RWLOCK_CONTENDED 2
+
+#define RWLOCK_NO_WRITER 0
+#define RWLOCK_WRITER 1
+#define RWLOCK_WRITER_AND_SLEEPERS 2
+
+#define RWLOCK_DRAIN_SLEEPER 1
+#define RWLOCK_DRAIN_EPOCH_STEP 2
+
+// spins of draining writer before sleeping
+#define RWLOCK_SPIN_LIMIT 100
+
+static _Atomic unsigned int next_slot_index = 0;
+
+// UINT_MAX - not assigned yet
+static _Thread_local unsigned int slot_index = UINT_MAX;
+
+static inline rwlock_slot_t *get_slot(rwlock_t *lock) {
+
+    if (slot_index == UINT_MAX) {
+        slot_index = atomic_fetch_add_explicit(&next_slot_index, 1, memory_order_relaxed) % RWLOCK_NUMBER_OF_SLOTS;
+    }
+
+    return lock->slots + slot_index;
+}
+
+rwlock_t *init_rwlock(bool prefer_writer) {
+
+    rwlock_t *lock = (rwlock_t*) aligned_alloc(RWLOCK_CACHE_LINE_SIZE, sizeof(rwlock_t));
+
+    if (!lock) {
+        return NULL;
+    }
+
+    atomic_init(&lock->writer_mutex, RWLOCK_UNLOCKED);
+    atomic_init(&lock->drain_epoch, 0);
+    atomic_init(&lock->write_phase, RWLOCK_NO_WRITER);
+    lock->prefer_writer = prefer_writer;
+
+    for (int i = 0; i < RWLOCK_NUMBER_OF_SLOTS; ++i) {
+        atomic_init(&lock->slots[i].readers, 0);
+    }
+
+    return lock;
+}
+
+/*
+ * Function assumes lock is released
+ */
+void close_rwlock(rwlock_t *lock) {
+    free(lock);
+}
+
+/*
+ * Sleeps while writer has raised write_phase
+ */
+static void wait_for_writer(rwlock_t *lock) {
+
+    uint32_t write_phase = atomic_load_explicit(&lock->write_phase, memory_order_relaxed);
+
+    while (write_phase != RWLOCK_NO_WRITER) {
+
+        // tell writer, that it has to wake us
+        if (write_phase == RWLOCK_WRITER &&
+            !atomic_compare_exchange_weak_explicit(&lock->write_phase, &write_phase, RWLOCK_WRITER_AND_SLEEPERS,
+                                                   memory_order_relaxed, memory_order_relaxed)) {
+            continue;
+        }
+
+        futex_wait(&lock->write_phase, RWLOCK_WRITER_AND_SLEEPERS);
+        write_phase = atomic_load_explicit(&lock->write_phase, memory_order_relaxed);
+    }
+}
+
+/*
+ * Drops write_phase and wakes readers sleeping on it
+ */
+static void release_write_phase(rwlock_t *lock) {
+    if (atomic_exchange_explicit(&lock->write_phase, RWLOCK_NO_WRITER, memory_order_release) == RWLOCK_WRITER_AND_SLEEPERS) {
+        futex_wake(&lock->write_phase, INT_MAX);
+    }
+}
+
+/*
+ * Takes reader's announcement back, wakes writer waiting for drain
+ *
+ * Decrement and drain_epoch check pair with sleeper bit setting and
+ * slot recheck of writer, all seq_cst: either writer sees empty slot,
+ * or reader sees the sleeper.
+ */
+static inline void leave_slot(rwlock_t *lock, rwlock_slot_t *slot) {
+
+    if (atomic_fetch_sub_explicit(&slot->readers, 1, memory_order_seq_cst) != 1) {
+        return;
+    }
+
+    uint32_t drain_epoch = atomic_load_explicit(&lock->drain_epoch, memory_order_seq_cst);
+
+    if ((drain_epoch & RWLOCK_DRAIN_SLEEPER) &&
+        atomic_compare_exchange_strong_explicit(&lock->drain_epoch, &drain_epoch,
+                                                (drain_epoch & ~RWLOCK_DRAIN_SLEEPER) + RWLOCK_DRAIN_EPOCH_STEP,
+                                                memory_order_release, memory_order_relaxed)) {
+        futex_wake(&lock->drain_epoch, 1);
+    }
+}
+
+/*
+ * Announcement and write_phase check are both seq_cst, as well as
+ * write_phase store and slot checks of writer: either reader sees
+ * the writer, or writer sees the reader.
+ */
+void rwlock_read_lock(rwlock_t *lock) {
+
+    rwlock_slot_t *slot = get_slot(lock);
+
+    for (;;) {
+
+        atomic_fetch_add_explicit(&slot->readers, 1, memory_order_seq_cst);
+
+        if (atomic_load_explicit(&lock->write_phase, memory_order_seq_cst) == RWLOCK_NO_WRITER) {
+            return;
+        }
+
+        leave_slot(lock, slot);
+        wait_for_writer(lock);
+    }
+}
+
+void rwlock_read_unlock(rwlock_t *lock) {
+    leave_slot(lock, get_slot(lock));
+}
+
+static void lock_writer_mutex(rwlock_t *lock) {
+
+    uint32_t expected_state = RWLOCK_UNLOCKED;
+
+    if (atomic_compare_exchange_strong_explicit(&lock->writer_mutex, &expected_state, RWLOCK_LOCKED,
+                                                memory_order_acquire, memory_order_relaxed)) {
+        return;
+    }
+
+    while (atomic_exchange_explicit(&lock->writer_mutex, RWLOCK_CONTENDED, memory_order_acquire) != RWLOCK_UNLOCKED) {
+        futex_wait(&lock->writer_mutex, RWLOCK_CONTENDED);
+    }
+}
+
+static void unlock_writer_mutex(rwlock_t *lock) {
+    if (atomic_exchange_explicit(&lock->writer_mutex, RWLOCK_UNLOCKED, memory_order_release) == RWLOCK_CONTENDED) {
+        futex_wake(&lock->writer_mutex, 1);
+    }
+}
+
+static bool has_readers(rwlock_t *lock) {
+
+    for (int i = 0; i < RWLOCK_NUMBER_OF_SLOTS; ++i) {
+        if (atomic_load_explicit(&lock->slots[i].readers, memory_order_seq_cst)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Spins, then announces itself as sleeper and sleeps until some slot
+ * empties. Slots are rechecked after announcement, reader emptying slot
+ * later changes drain_epoch, so futex_wait does not miss it.
+ */
+static void wait_for_readers(rwlock_t *lock) {
+
+    unsigned int spin_counter = 0;
+
+    while (has_readers(lock)) {
+
+        if (++spin_counter < RWLOCK_SPIN_LIMIT) {
+            cpu_relax();
+            continue;
+        }
+
+        uint32_t drain_epoch = atomic_fetch_or_explicit(&lock->drain_epoch, RWLOCK_DRAIN_SLEEPER,
+                                                        memory_order_seq_cst) | RWLOCK_DRAIN_SLEEPER;
+
+        if (!has_readers(lock)) {
+            break;
+        }
+
+        futex_wait(&lock->drain_epoch, drain_epoch);
+    }
+
+    // nobody has to wake us anymore
+    atomic_fetch_and_explicit(&lock->drain_epoch, ~RWLOCK_DRAIN_SLEEPER, memory_order_relaxed);
+}
+
+void rwlock_write_lock(rwlock_t *lock) {
+
+    lock_writer_mutex(lock);
+
+    if (lock->prefer_writer) {
+        atomic_store_explicit(&lock->write_phase, RWLOCK_WRITER, memory_order_seq_cst);
+        wait_for_readers(lock);
+        return;
+    }
+
+    for (;;) {
+
+        wait_for_readers(lock);
+
+        atomic_store_explicit(&lock->write_phase, RWLOCK_WRITER, memory_order_seq_cst);
+
+        if (!has_readers(lock)) {
+            return;
+        }
+
+        // reader has come between the checks, let it through
+        release_write_phase(lock);
+    }
+}
+
+void rwlock_write_unlock(rwlock_t *lock) {
+    release_write_phase(lock);
+    unlock_writer_mutex(lock);
+}
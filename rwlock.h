@@ -0,0 +1,51 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/*
+ * Reader-writer lock with distributed reader indicators
+ *
+ * Every reader thread announces itself in its own cache line padded
+ * slot, so read lock and unlock touch no line shared with other
+ * readers. Writer excludes other writers, raises write_phase and waits
+ * until all slots drain, spinning first and then sleeping until the
+ * last reader leaves. Reader, that sees write_phase raised, takes
+ * its announcement back and sleeps until the writer leaves.
+ *
+ * Threads are mapped to slots round robin, when there are more threads
+ * than slots, the slot is shared and its count is above one.
+ *
+ * With prefer_writer new readers back off as soon as a writer arrives.
+ * Otherwise writer raises write_phase only after slots drain and backs
+ * off again if a reader has slipped in, so a stream of overlapping
+ * readers may starve writers.
+ */
+#define RWLOCK_CACHE_LINE_SIZE 64
+#define RWLOCK_NUMBER_OF_SLOTS 64
+
+typedef struct {
+    _Alignas(RWLOCK_CACHE_LINE_SIZE) _Atomic unsigned long readers;
+} rwlock_slot_t;
+
+typedef struct {
+    // futex mutex between writers: 0 - unlocked, 1 - locked, 2 - contended
+    _Alignas(RWLOCK_CACHE_LINE_SIZE) futex_word_t writer_mutex;
+    // writer sleeps on it waiting for readers to drain, lowest bit is set
+    // while writer sleeps, reader emptying its slot bumps it then
+    futex_word_t drain_epoch;
+    // 0 - no writer, 1 - readers must back off, 2 - and some of them sleep
+    _Alignas(RWLOCK_CACHE_LINE_SIZE) futex_word_t write_phase;
+    bool prefer_writer;
+    rwlock_slot_t slots[RWLOCK_NUMBER_OF_SLOTS];
+} rwlock_t;
+
+rwlock_t *init_rwlock(bool prefer_writer);
+
+void close_rwlock(rwlock_t *lock);
+
+void rwlock_read_lock(rwlock_t *lock);
+
+void rwlock_read_unlock(rwlock_t *lock);
+
+void rwlock_write_lock(rwlock_t *lock);
+
+void rwlock_write_unlock(rwlock_t *lock);
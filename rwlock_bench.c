@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_RWLOCK_
+#define ST_RWLOCK_
+#include "rwlock.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define MAX_NUMBER_OF_THREADS 16
+#define BENCH_DURATION_NS 200000000L
+// one write per that many operations
+#define READS_PER_WRITE 100
+
+typedef enum {
+    PTHREAD_RWLOCK,
+    RWLOCK_PREFER_READER,
+    RWLOCK_PREFER_WRITER
+} rwlock_kind_t;
+
+static const char *rwlock_kind_names[] = {
+    "pthread_rwlock_t",
+    "rwlock_t (reader)",
+    "rwlock_t (writer)"
+};
+
+typedef struct {
+    rwlock_kind_t kind;
+    pthread_rwlock_t pthread_lock;
+    rwlock_t *lock;
+    atomic_bool is_running;
+    pthread_barrier_t start_barrier;
+    // writers keep both fields equal
+    long first_field;
+    long second_field;
+} rwlock_bench_t;
+
+typedef struct {
+    rwlock_bench_t *bench;
+    long operations;
+    long torn_reads;
+} rwlock_worker_input_t;
+
+static void bench_read_lock(rwlock_bench_t *bench) {
+    if (bench->kind == PTHREAD_RWLOCK) {
+        pthread_rwlock_rdlock(&bench->pthread_lock);
+    } else {
+        rwlock_read_lock(bench->lock);
+    }
+}
+
+static void bench_read_unlock(rwlock_bench_t *bench) {
+    if (bench->kind == PTHREAD_RWLOCK) {
+        pthread_rwlock_unlock(&bench->pthread_lock);
+    } else {
+        rwlock_read_unlock(bench->lock);
+    }
+}
+
+static void bench_write_lock(rwlock_bench_t *bench) {
+    if (bench->kind == PTHREAD_RWLOCK) {
+        pthread_rwlock_wrlock(&bench->pthread_lock);
+    } else {
+        rwlock_write_lock(bench->lock);
+    }
+}
+
+static void bench_write_unlock(rwlock_bench_t *bench) {
+    if (bench->kind == PTHREAD_RWLOCK) {
+        pthread_rwlock_unlock(&bench->pthread_lock);
+    } else {
+        rwlock_write_unlock(bench->lock);
+    }
+}
+
+static void *rwlock_worker(void *data) {
+
+    rwlock_worker_input_t *input = (rwlock_worker_input_t*) data;
+    rwlock_bench_t *bench = input->bench;
+
+    pthread_barrier_wait(&bench->start_barrier);
+
+    while (atomic_load_explicit(&bench->is_running, memory_order_relaxed)) {
+
+        if (input->operations % READS_PER_WRITE == 0) {
+            bench_write_lock(bench);
+            ++bench->first_field;
+            ++bench->second_field;
+            bench_write_unlock(bench);
+        } else {
+            bench_read_lock(bench);
+            long first_field = bench->first_field;
+            __asm__ __volatile__("" ::: "memory");
+            long second_field = bench->second_field;
+            bench_read_unlock(bench);
+
+            input->torn_reads += first_field != second_field;
+        }
+
+        ++input->operations;
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns 0 if readers have never seen half done write
+ */
+int bench_rwlock(rwlock_kind_t kind, int number_of_threads) {
+
+    rwlock_bench_t bench;
+    bench.kind = kind;
+    pthread_rwlock_init(&bench.pthread_lock, NULL);
+    bench.lock = init_rwlock(kind == RWLOCK_PREFER_WRITER);
+    atomic_init(&bench.is_running, true);
+    pthread_barrier_init(&bench.start_barrier, NULL, number_of_threads + 1);
+    bench.first_field = 0;
+    bench.second_field = 0;
+
+    pthread_t thread_ids[MAX_NUMBER_OF_THREADS];
+    rwlock_worker_input_t inputs[MAX_NUMBER_OF_THREADS];
+
+    for (int i = 0; i < number_of_threads; ++i) {
+        inputs[i].bench = &bench;
+        inputs[i].operations = 0;
+        inputs[i].torn_reads = 0;
+        pthread_create(thread_ids + i, NULL, rwlock_worker, inputs + i);
+    }
+
+    pthread_barrier_wait(&bench.start_barrier);
+
+    struct timespec duration = { 0, BENCH_DURATION_NS };
+    nanosleep(&duration, NULL);
+
+    atomic_store(&bench.is_running, false);
+
+    long operations = 0;
+    long torn_reads = 0;
+    for (int i = 0; i < number_of_threads; ++i) {
+        pthread_join(thread_ids[i], NULL);
+        operations += inputs[i].operations;
+        torn_reads += inputs[i].torn_reads;
+    }
+
+    printf("%-17s threads=%2d: %8.2f M operations/s\n",
+           rwlock_kind_names[kind], number_of_threads,
+           operations / (BENCH_DURATION_NS * 1e-9) * 1e-6);
+
+    pthread_barrier_destroy(&bench.start_barrier);
+    close_rwlock(bench.lock);
+    pthread_rwlock_destroy(&bench.pthread_lock);
+
+    return torn_reads ? 1 : 0;
+}
+
+int main() {
+
+    int result = 0;
+
+    for (int n = 1; n <= MAX_NUMBER_OF_THREADS; n *= 2) {
+        result |= bench_rwlock(PTHREAD_RWLOCK, n);
+        result |= bench_rwlock(RWLOCK_PREFER_READER, n);
+        result |= bench_rwlock(RWLOCK_PREFER_WRITER, n);
+    }
+
+    printf(result ? "Failure\n" : "Success\n");
+
+    return result;
+}
@@ -0,0 +1,144 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+/*
+ * Sequence lock for small read-mostly records
+ *
+ * Writer makes sequence odd, updates the record and makes it even
+ * again. Reader copies the record between two reads of sequence and
+ * retries if sequence was odd or has changed. Readers never write
+ * shared memory, so they do not bounce cache lines between each other,
+ * but they may retry while writer is active.
+ *
+ * Record copy may race with writer, the copy is thrown away then.
+ * Record should not contain pointers reader follows before the copy
+ * is validated.
+ *
+ * Writers exclude each other by spinning on odd sequence, so writes
+ * are expected to be short and rare.
+ */
+
+
+#define SEQLOCK_SPIN_LIMIT 100
+
+
+typedef struct {
+    _Atomic unsigned int sequence;
+} seqlock_t;
+
+
+static inline void seqlock_init(seqlock_t *lock) {
+    atomic_init(&lock->sequence, 0);
+}
+
+
+/**
+ * @function waits until there is no writer
+ * @returns  sequence to pass to seqlock_read_retry
+ */
+static inline unsigned int seqlock_read_begin(seqlock_t *lock) {
+
+    unsigned int spin_counter = 0;
+    unsigned int sequence;
+
+    while ((sequence = atomic_load_explicit(&lock->sequence, memory_order_acquire)) & 1) {
+        spin_wait_step(&spin_counter, SEQLOCK_SPIN_LIMIT);
+    }
+
+    return sequence;
+}
+
+
+/**
+ * @function checks, whether data read since seqlock_read_begin may be torn
+ * @brief    Acquire fence keeps reads of the record before sequence recheck
+ */
+static inline bool seqlock_read_retry(seqlock_t *lock, unsigned int sequence) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&lock->sequence, memory_order_relaxed) != sequence;
+}
+
+
+static inline void seqlock_write_lock(seqlock_t *lock) {
+
+    unsigned int spin_counter = 0;
+    unsigned int sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+
+    for (;;) {
+
+        if (!(sequence & 1) &&
+            atomic_compare_exchange_weak_explicit(&lock->sequence, &sequence, sequence + 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            break;
+        }
+
+        spin_wait_step(&spin_counter, SEQLOCK_SPIN_LIMIT);
+        sequence = atomic_load_explicit(&lock->sequence, memory_order_relaxed);
+    }
+
+    // Acquire on success syncs with release of previous writer's unlock,
+    // so its stores to the record happen before ours. Release fence
+    // makes odd sequence visible to readers before any store to the record
+    atomic_thread_fence(memory_order_release);
+}
+
+
+static inline void seqlock_write_unlock(seqlock_t *lock) {
+    atomic_fetch_add_explicit(&lock->sequence, 1, memory_order_release);
+}
+
+
+/**
+ * @function copies consistent snapshot of size bytes from source
+ */
+static inline void seqlock_read(seqlock_t *lock, void *destination, const void *source, size_t size) {
+
+    unsigned int sequence;
+
+    do {
+        sequence = seqlock_read_begin(lock);
+        memcpy(destination, source, size);
+    } while (seqlock_read_retry(lock, sequence));
+}
+
+
+/**
+ * @function replaces size bytes of destination under the lock
+ */
+static inline void seqlock_write(seqlock_t *lock, void *destination, const void *source, size_t size) {
+    seqlock_write_lock(lock);
+    memcpy(destination, source, size);
+    seqlock_write_unlock(lock);
+}
+
+
+/**
+ * @function defines record type name_t with a value of type protected by seqlock
+ * @brief    Generates name_init, name_load and name_store, that copy
+ *           the whole value:
+ *
+ *               DEFINE_SEQLOCKED(config, config_t)
+ *
+ *               config_t snapshot;
+ *               config_load(&shared_config, &snapshot);
+ */
+#define DEFINE_SEQLOCKED(name, type)                                        \
+    typedef struct {                                                        \
+        seqlock_t lock;                                                     \
+        type value;                                                         \
+    } name##_t;                                                             \
+                                                                            \
+    static inline void name##_init(name##_t *record, const type *value) {   \
+        seqlock_init(&record->lock);                                        \
+        record->value = *value;                                             \
+    }                                                                       \
+                                                                            \
+    static inline void name##_load(name##_t *record, type *value) {         \
+        seqlock_read(&record->lock, value, &record->value, sizeof(type));   \
+    }                                                                       \
+                                                                            \
+    static inline void name##_store(name##_t *record, const type *value) {  \
+        seqlock_write(&record->lock, &record->value, value, sizeof(type));  \
+    }
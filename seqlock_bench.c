@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_SEQLOCK_
+#define ST_SEQLOCK_
+#include "seqlock.h"
+#endif
+
+#ifndef ST_RWLOCK_
+#define ST_RWLOCK_
+#include "rwlock.h"
+#endif
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+#define NUMBER_OF_READERS 32
+#define BENCH_DURATION_NS 200000000L
+#define STATS_FIELDS 8
+
+typedef struct {
+    long fields[STATS_FIELDS];
+} stats_t;
+
+DEFINE_SEQLOCKED(seqlocked_stats, stats_t)
+
+typedef enum {
+    SEQLOCK,
+    PTHREAD_MUTEX,
+    PTHREAD_RWLOCK,
+    RWLOCK
+} lock_kind_t;
+
+static const char *lock_kind_names[] = {
+    "seqlock_t",
+    "pthread_mutex_t",
+    "pthread_rwlock_t",
+    "rwlock_t"
+};
+
+typedef struct {
+    lock_kind_t kind;
+    seqlocked_stats_t seqlocked_stats;
+    pthread_mutex_t mutex;
+    pthread_rwlock_t pthread_rwlock;
+    rwlock_t *rwlock;
+    stats_t stats;
+    atomic_bool is_running;
+    pthread_barrier_t start_barrier;
+} stats_bench_t;
+
+typedef struct {
+    stats_bench_t *bench;
+    long operations;
+    long torn_reads;
+} stats_worker_input_t;
+
+static void load_stats(stats_bench_t *bench, stats_t *snapshot) {
+    switch (bench->kind) {
+    case SEQLOCK:
+        seqlocked_stats_load(&bench->seqlocked_stats, snapshot);
+        break;
+    case PTHREAD_MUTEX:
+        pthread_mutex_lock(&bench->mutex);
+        *snapshot = bench->stats;
+        pthread_mutex_unlock(&bench->mutex);
+        break;
+    case PTHREAD_RWLOCK:
+        pthread_rwlock_rdlock(&bench->pthread_rwlock);
+        *snapshot = bench->stats;
+        pthread_rwlock_unlock(&bench->pthread_rwlock);
+        break;
+    case RWLOCK:
+        rwlock_read_lock(bench->rwlock);
+        *snapshot = bench->stats;
+        rwlock_read_unlock(bench->rwlock);
+        break;
+    }
+}
+
+static void store_stats(stats_bench_t *bench, const stats_t *stats) {
+    switch (bench->kind) {
+    case SEQLOCK:
+        seqlocked_stats_store(&bench->seqlocked_stats, stats);
+        break;
+    case PTHREAD_MUTEX:
+        pthread_mutex_lock(&bench->mutex);
+        bench->stats = *stats;
+        pthread_mutex_unlock(&bench->mutex);
+        break;
+    case PTHREAD_RWLOCK:
+        pthread_rwlock_wrlock(&bench->pthread_rwlock);
+        bench->stats = *stats;
+        pthread_rwlock_unlock(&bench->pthread_rwlock);
+        break;
+    case RWLOCK:
+        rwlock_write_lock(bench->rwlock);
+        bench->stats = *stats;
+        rwlock_write_unlock(bench->rwlock);
+        break;
+    }
+}
+
+static void *stats_reader(void *data) {
+
+    stats_worker_input_t *input = (stats_worker_input_t*) data;
+    stats_bench_t *bench = input->bench;
+
+    pthread_barrier_wait(&bench->start_barrier);
+
+    while (atomic_load_explicit(&bench->is_running, memory_order_relaxed)) {
+
+        stats_t snapshot;
+        load_stats(bench, &snapshot);
+
+        for (int i = 1; i < STATS_FIELDS; ++i) {
+            if (snapshot.fields[i] != snapshot.fields[0]) {
+                ++input->torn_reads;
+                break;
+            }
+        }
+
+        ++input->operations;
+    }
+
+    return NULL;
+}
+
+static void *stats_writer(void *data) {
+
+    stats_worker_input_t *input = (stats_worker_input_t*) data;
+    stats_bench_t *bench = input->bench;
+
+    pthread_barrier_wait(&bench->start_barrier);
+
+    while (atomic_load_explicit(&bench->is_running, memory_order_relaxed)) {
+
+        stats_t stats;
+        for (int i = 0; i < STATS_FIELDS; ++i) {
+            stats.fields[i] = input->operations;
+        }
+
+        store_stats(bench, &stats);
+
+        ++input->operations;
+    }
+
+    return NULL;
+}
+
+/*
+ * One writer updates record constantly, readers take snapshots
+ *
+ * Returns 0 if readers have never seen half done update
+ */
+int bench_stats(lock_kind_t kind) {
+
+    stats_bench_t bench;
+    bench.kind = kind;
+
+    stats_t zero_stats = { { 0 } };
+    seqlocked_stats_init(&bench.seqlocked_stats, &zero_stats);
+    pthread_mutex_init(&bench.mutex, NULL);
+
+    // readers would starve the only writer otherwise
+    pthread_rwlockattr_t rwlock_attr;
+    pthread_rwlockattr_init(&rwlock_attr);
+    pthread_rwlockattr_setkind_np(&rwlock_attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&bench.pthread_rwlock, &rwlock_attr);
+    pthread_rwlockattr_destroy(&rwlock_attr);
+    bench.rwlock = init_rwlock(true);
+
+    bench.stats = zero_stats;
+    atomic_init(&bench.is_running, true);
+    pthread_barrier_init(&bench.start_barrier, NULL, NUMBER_OF_READERS + 2);
+
+    pthread_t thread_ids[NUMBER_OF_READERS + 1];
+    stats_worker_input_t inputs[NUMBER_OF_READERS + 1];
+
+    for (int i = 0; i <= NUMBER_OF_READERS; ++i) {
+        inputs[i].bench = &bench;
+        inputs[i].operations = 0;
+        inputs[i].torn_reads = 0;
+        pthread_create(thread_ids + i, NULL, i ? stats_reader : stats_writer, inputs + i);
+    }
+
+    pthread_barrier_wait(&bench.start_barrier);
+
+    struct timespec duration = { 0, BENCH_DURATION_NS };
+    nanosleep(&duration, NULL);
+
+    atomic_store(&bench.is_running, false);
+
+    long reads = 0;
+    long torn_reads = 0;
+    for (int i = 0; i <= NUMBER_OF_READERS; ++i) {
+        pthread_join(thread_ids[i], NULL);
+        if (i) {
+            reads += inputs[i].operations;
+            torn_reads += inputs[i].torn_reads;
+        }
+    }
+
+    printf("%-16s 1 writer, %d readers: %8.2f M reads/s, %8.2f M writes/s\n",
+           lock_kind_names[kind], NUMBER_OF_READERS,
+           reads / (BENCH_DURATION_NS * 1e-9) * 1e-6,
+           inputs[0].operations / (BENCH_DURATION_NS * 1e-9) * 1e-6);
+
+    pthread_barrier_destroy(&bench.start_barrier);
+    close_rwlock(bench.rwlock);
+    pthread_rwlock_destroy(&bench.pthread_rwlock);
+    pthread_mutex_destroy(&bench.mutex);
+
+    return torn_reads ? 1 : 0;
+}
+
+int main() {
+
+    int result = 0;
+
+    result |= bench_stats(SEQLOCK);
+    result |= bench_stats(PTHREAD_MUTEX);
+    result |= bench_stats(PTHREAD_RWLOCK);
+    result |= bench_stats(RWLOCK);
+
+    printf(result ? "Failure\n" : "Success\n");
+
+    return result;
+}
@@ -0,0 +1,365 @@
+#include <stdlib.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_SKIP_LIST_
+#define ST_SKIP_LIST_
+#include "skip_list.h"
+#endif
+
+#define SKIP_LIST_SLAB_SIZE 16384
+
+
+/**
+ * @returns size of node with given number of links
+ */
+static inline size_t get_skip_list_node_size(size_t level) {
+  return sizeof(skip_list_node_t) + level * sizeof(skip_list_link_t);
+}
+
+
+/**
+ * @function Takes node of given level from pool
+ * @brief Free node of the same level is reused first, otherwise node
+ *        is cut from current slab. Rest of slab, that is too small,
+ *        is dropped until the list is closed
+ * @returns pointer to node or NULL if error
+ */
+static skip_list_node_t *alloc_skip_list_node(skip_list_pool_t *pool, size_t level) {
+
+  skip_list_node_t *node = pool->free_nodes[level - 1];
+
+  if (node) {
+    pool->free_nodes[level - 1] = node->links[0].next;
+    return node;
+  }
+
+  size_t node_size = get_skip_list_node_size(level);
+
+  if (pool->slab_bytes_left < node_size) {
+
+    void **slab = (void**) malloc(SKIP_LIST_SLAB_SIZE);
+    if (!slab) {
+      return NULL;
+    }
+
+    // slab starts with pointer to previous one, nodes follow it
+    *slab = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_cursor = (char*) (slab + 1);
+    pool->slab_bytes_left = SKIP_LIST_SLAB_SIZE - sizeof(void*);
+  }
+
+  node = (skip_list_node_t*) pool->slab_cursor;
+  pool->slab_cursor += node_size;
+  pool->slab_bytes_left -= node_size;
+
+  return node;
+}
+
+
+static void free_skip_list_node(skip_list_pool_t *pool, skip_list_node_t *node) {
+  node->links[0].next = pool->free_nodes[node->level - 1];
+  pool->free_nodes[node->level - 1] = node;
+}
+
+
+/**
+ * @returns level of new node, level i + 1 is 4 times less likely than level i
+ */
+static size_t get_random_skip_list_level(skip_list_t *list) {
+
+  // xorshift64
+  uint64_t random = list->random_state;
+  random ^= random << 13;
+  random ^= random >> 7;
+  random ^= random << 17;
+  list->random_state = random;
+
+  size_t level = 1;
+
+  while ((random & 3) == 0 && level < SKIP_LIST_MAX_LEVEL) {
+    ++level;
+    random >>= 2;
+  }
+
+  return level;
+}
+
+
+/**
+ * @function Initializes empty skip list
+ * @returns pointer to the created list or NULL if error
+ */
+skip_list_t *init_skip_list(list_compare_func_t compare) {
+
+  skip_list_t *list = (skip_list_t*) malloc(sizeof(skip_list_t));
+  if (!list) {
+    return NULL;
+  }
+
+  list->head = (skip_list_node_t*) malloc(get_skip_list_node_size(SKIP_LIST_MAX_LEVEL));
+  if (!list->head) {
+    free(list);
+    return NULL;
+  }
+
+  list->head->data = NULL;
+  list->head->level = SKIP_LIST_MAX_LEVEL;
+
+  for (size_t i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+    list->head->links[i].next = NULL;
+    list->head->links[i].span = 0;
+  }
+
+  list->level = 1;
+  list->length = 0;
+  list->compare = compare;
+  list->random_state = (uintptr_t) list | 1;
+
+  for (size_t i = 0; i < SKIP_LIST_MAX_LEVEL; ++i) {
+    list->pool.free_nodes[i] = NULL;
+  }
+
+  list->pool.slabs = NULL;
+  list->pool.slab_cursor = NULL;
+  list->pool.slab_bytes_left = 0;
+
+  return list;
+}
+
+
+/**
+ * @function Frees data of all items, pool and list itself
+ */
+void close_skip_list(skip_list_t *list) {
+
+  skip_list_node_t *node = list->head->links[0].next;
+
+  while (node) {
+    free_list_item_data(node->data);
+    node = node->links[0].next;
+  }
+
+  void *slab = list->pool.slabs;
+
+  while (slab) {
+    void *prev_slab = *(void**) slab;
+    free(slab);
+    slab = prev_slab;
+  }
+
+  free(list->head);
+  free(list);
+}
+
+
+/**
+ * @function Finds last node before key at every level
+ * @brief rank[i] is number of items before update[i]
+ * @returns node at level 0, that follows all items less than key
+ */
+static skip_list_node_t *find_skip_list_predecessors(skip_list_t *list, void *key,
+                                                     skip_list_node_t **update, size_t *rank) {
+
+  skip_list_node_t *node = list->head;
+  size_t passed = 0;
+
+  for (size_t i = list->level; i-- > 0;) {
+
+    skip_list_node_t *next_node;
+
+    while ((next_node = node->links[i].next) && (*list->compare)(next_node->data->data_ptr, key) < 0) {
+      passed += node->links[i].span;
+      node = next_node;
+    }
+
+    update[i] = node;
+    rank[i] = passed;
+  }
+
+  return node->links[0].next;
+}
+
+
+/**
+ * @function Inserts item at its place in order
+ * @returns 0 on success, 1 if equal item is already in list and
+ *          item_data is left to caller, -1 if error
+ */
+int skip_list_insert(skip_list_t *list, list_item_data_t *item_data) {
+
+  skip_list_node_t *update[SKIP_LIST_MAX_LEVEL];
+  size_t rank[SKIP_LIST_MAX_LEVEL];
+
+  skip_list_node_t *next_node = find_skip_list_predecessors(list, item_data->data_ptr, update, rank);
+
+  if (next_node && (*list->compare)(next_node->data->data_ptr, item_data->data_ptr) == 0) {
+    return 1;
+  }
+
+  size_t level = get_random_skip_list_level(list);
+
+  skip_list_node_t *node = alloc_skip_list_node(&list->pool, level);
+  if (!node) {
+    return -1;
+  }
+
+  // new levels start at head, that spans over the whole list
+  for (size_t i = list->level; i < level; ++i) {
+    update[i] = list->head;
+    rank[i] = 0;
+    list->head->links[i].span = list->length;
+  }
+
+  if (level > list->level) {
+    list->level = level;
+  }
+
+  node->data = item_data;
+  node->level = level;
+
+  for (size_t i = 0; i < level; ++i) {
+    size_t steps_to_node = rank[0] - rank[i] + 1;
+
+    node->links[i].next = update[i]->links[i].next;
+    node->links[i].span = update[i]->links[i].span - (steps_to_node - 1);
+    update[i]->links[i].next = node;
+    update[i]->links[i].span = steps_to_node;
+  }
+
+  // higher links now jump over one more item
+  for (size_t i = level; i < list->level; ++i) {
+    ++update[i]->links[i].span;
+  }
+
+  ++list->length;
+
+  return 0;
+}
+
+
+/**
+ * @returns node with data equal to key or NULL if there is no such one
+ */
+skip_list_node_t *skip_list_search(skip_list_t *list, void *key) {
+
+  skip_list_node_t *node = skip_list_lower_bound(list, key);
+
+  if (node && (*list->compare)(node->data->data_ptr, key) == 0) {
+    return node;
+  }
+
+  return NULL;
+}
+
+
+/**
+ * @function Removes item equal to key and frees its data
+ * @returns 0 on success, -1 if there is no such item
+ */
+int skip_list_remove(skip_list_t *list, void *key) {
+
+  skip_list_node_t *update[SKIP_LIST_MAX_LEVEL];
+  size_t rank[SKIP_LIST_MAX_LEVEL];
+
+  skip_list_node_t *node = find_skip_list_predecessors(list, key, update, rank);
+
+  if (!node || (*list->compare)(node->data->data_ptr, key) != 0) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < list->level; ++i) {
+    if (update[i]->links[i].next == node) {
+      update[i]->links[i].span += node->links[i].span - 1;
+      update[i]->links[i].next = node->links[i].next;
+    } else {
+      --update[i]->links[i].span;
+    }
+  }
+
+  while (list->level > 1 && !list->head->links[list->level - 1].next) {
+    --list->level;
+  }
+
+  --list->length;
+
+  free_list_item_data(node->data);
+  free_skip_list_node(&list->pool, node);
+
+  return 0;
+}
+
+
+/**
+ * @returns first node with data not less than key or NULL if there is no such one
+ */
+skip_list_node_t *skip_list_lower_bound(skip_list_t *list, void *key) {
+
+  skip_list_node_t *node = list->head;
+
+  for (size_t i = list->level; i-- > 0;) {
+
+    skip_list_node_t *next_node;
+
+    while ((next_node = node->links[i].next) && (*list->compare)(next_node->data->data_ptr, key) < 0) {
+      node = next_node;
+    }
+  }
+
+  return node->links[0].next;
+}
+
+
+/**
+ * @returns number of items less than key
+ */
+size_t skip_list_rank(skip_list_t *list, void *key) {
+
+  skip_list_node_t *node = list->head;
+  size_t rank = 0;
+
+  for (size_t i = list->level; i-- > 0;) {
+
+    skip_list_node_t *next_node;
+
+    while ((next_node = node->links[i].next) && (*list->compare)(next_node->data->data_ptr, key) < 0) {
+      rank += node->links[i].span;
+      node = next_node;
+    }
+  }
+
+  return rank;
+}
+
+
+/**
+ * @returns node with given number of items before it or NULL if rank is out of range
+ */
+skip_list_node_t *skip_list_get_by_rank(skip_list_t *list, size_t rank) {
+
+  if (rank >= list->length) {
+    return NULL;
+  }
+
+  skip_list_node_t *node = list->head;
+
+  // head is at position 0, items - from position 1
+  size_t position = 0;
+
+  for (size_t i = list->level; i-- > 0;) {
+    while (node->links[i].next && position + node->links[i].span <= rank + 1) {
+      position += node->links[i].span;
+      node = node->links[i].next;
+    }
+
+    if (position == rank + 1) {
+      return node;
+    }
+  }
+
+  return NULL;
+}
@@ -0,0 +1,138 @@
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*
+ * Skip list
+ *
+ * Ordered set of list_item_data_t, no two items compare equal. Node
+ * of level h keeps h links inline, link of level i skips over about
+ * 4^i items. Every link counts items it skips over, so rank queries
+ * take expected O(log n) as search does. Nodes come from pool of the
+ * list: one free list per level, new nodes are cut from slabs, that
+ * are freed with the list. List is not thread safe, like list_t.
+ *
+ * Needs list.h included before.
+ */
+
+
+#define SKIP_LIST_MAX_LEVEL 32
+
+
+/**
+ * @struct Link of skip list's node at one level
+ *
+ * @prop {next} next node at this level, NULL at the end
+ * @prop {span} number of level 0 steps to next node
+ */
+typedef struct {
+  struct skip_list_node_t_ *next;
+  size_t span;
+} skip_list_link_t;
+
+
+/**
+ * @struct Skip list's node
+ *
+ * @prop {data} item data, freed with free_list_item_data
+ * @prop {level} number of links
+ * @prop {links} links from level 0 up
+ */
+typedef struct skip_list_node_t_ {
+  list_item_data_t *data;
+  size_t level;
+  skip_list_link_t links[];
+} skip_list_node_t;
+
+
+/**
+ * @struct Pool of skip list's nodes
+ *
+ * @prop {free_nodes} free nodes of level i + 1, chained through links[0].next
+ * @prop {slabs} allocated slabs, chained through their first word
+ * @prop {slab_cursor} start of unused memory of current slab
+ * @prop {slab_bytes_left} size of unused memory of current slab
+ */
+typedef struct {
+  skip_list_node_t *free_nodes[SKIP_LIST_MAX_LEVEL];
+  void *slabs;
+  char *slab_cursor;
+  size_t slab_bytes_left;
+} skip_list_pool_t;
+
+
+/**
+ * @struct Skip list
+ *
+ * @prop {head} dummy node with SKIP_LIST_MAX_LEVEL links
+ * @prop {level} number of levels in use
+ * @prop {length} number of items
+ * @prop {compare} compares data pointers of two items
+ * @prop {random_state} state of generator of node levels
+ */
+typedef struct {
+  skip_list_node_t *head;
+  size_t level;
+  size_t length;
+  list_compare_func_t compare;
+  uint64_t random_state;
+  skip_list_pool_t pool;
+} skip_list_t;
+
+
+skip_list_t *init_skip_list(list_compare_func_t compare);
+
+
+void close_skip_list(skip_list_t *list);
+
+
+int skip_list_insert(skip_list_t *list, list_item_data_t *item_data);
+
+
+skip_list_node_t *skip_list_search(skip_list_t *list, void *key);
+
+
+int skip_list_remove(skip_list_t *list, void *key);
+
+
+skip_list_node_t *skip_list_lower_bound(skip_list_t *list, void *key);
+
+
+size_t skip_list_rank(skip_list_t *list, void *key);
+
+
+skip_list_node_t *skip_list_get_by_rank(skip_list_t *list, size_t rank);
+
+
+static inline size_t get_skip_list_length(skip_list_t *list) {
+  return list->length;
+}
+
+
+static inline int is_skip_list_empty(skip_list_t *list) {
+  return list->length == 0;
+}
+
+
+static inline skip_list_node_t *get_skip_list_first(skip_list_t *list) {
+  return list->head->links[0].next;
+}
+
+
+static inline skip_list_node_t *get_skip_list_next(skip_list_node_t *node) {
+  return node->links[0].next;
+}
+
+
+static inline void *get_skip_list_node_data(skip_list_node_t *node) {
+  return node ? node->data->data_ptr : NULL;
+}
+
+
+/**
+ * @function iterates over nodes with from <= data < to in order
+ */
+#define for_each_in_skip_list_range(list, node, from, to)                 \
+  for (skip_list_node_t *node = skip_list_lower_bound((list), (from));   \
+       node && (*(list)->compare)(node->data->data_ptr, (to)) < 0;        \
+       node = get_skip_list_next(node))
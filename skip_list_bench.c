@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_SKIP_LIST_
+#define ST_SKIP_LIST_
+#include "skip_list.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int TEST_OPERATIONS = 200000;
+const long TEST_KEY_RANGE = 5000;
+const int SKIP_LIST_LOOKUPS = 1000000;
+const int LIST_LOOKUPS = 2000;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void do_nothing(void *data) {
+  (void) data;
+}
+
+
+static int compare_keys(void *first, void *second) {
+  long first_key = (long) first;
+  long second_key = (long) second;
+  return first_key < second_key ? -1 : first_key > second_key;
+}
+
+
+/**
+ * @function random inserts, removes and queries, mirrored by presence array
+ * @returns  0 if list and array agree
+ */
+int test_skip_list_operations() {
+
+  skip_list_t *list = init_skip_list(compare_keys);
+  char *is_present = (char*) calloc(TEST_KEY_RANGE, 1);
+  size_t length = 0;
+  int is_equal = 1;
+
+  srand(42);
+
+  for (int i = 0; i < TEST_OPERATIONS && is_equal; ++i) {
+
+    long key = rand() % TEST_KEY_RANGE;
+    int operation = rand() % 4;
+
+    if (operation == 0) {
+      list_item_data_t *item_data = init_list_item_data((void*) key, do_nothing);
+      int result = skip_list_insert(list, item_data);
+      is_equal = result == is_present[key];
+      if (result) {
+        free_list_item_data(item_data);
+      }
+      length += !is_present[key];
+      is_present[key] = 1;
+    } else if (operation == 1) {
+      is_equal = (skip_list_remove(list, (void*) key) == 0) == is_present[key];
+      length -= is_present[key];
+      is_present[key] = 0;
+    } else if (operation == 2) {
+      is_equal = (skip_list_search(list, (void*) key) != NULL) == is_present[key];
+    } else {
+      // rank of key and item at that rank
+      size_t rank = 0;
+      long next_key = key;
+      for (long k = 0; k < key; ++k) {
+        rank += is_present[k];
+      }
+      while (next_key < TEST_KEY_RANGE && !is_present[next_key]) {
+        ++next_key;
+      }
+      skip_list_node_t *node = skip_list_get_by_rank(list, rank);
+      is_equal = skip_list_rank(list, (void*) key) == rank &&
+                 (next_key == TEST_KEY_RANGE ? node == NULL : (long) get_skip_list_node_data(node) == next_key);
+    }
+
+    is_equal = is_equal && get_skip_list_length(list) == length;
+  }
+
+  // range [100, 200) in order
+  long expected_key = 100;
+  for_each_in_skip_list_range(list, node, (void*) 100, (void*) 200) {
+    while (!is_present[expected_key]) {
+      ++expected_key;
+    }
+    is_equal = is_equal && (long) get_skip_list_node_data(node) == expected_key++;
+  }
+
+  close_skip_list(list);
+  free(is_present);
+
+  printf("test_skip_list_operations: %s\n", is_equal ? "Success" : "Failure");
+
+  return is_equal ? 0 : 1;
+}
+
+
+/**
+ * @function looks up random keys in ordered list_t and in skip list
+ * @returns  0 if both have found the same number of keys
+ */
+int bench_lookup(long number_of_items) {
+
+  list_t *list = init_list();
+  skip_list_t *skip_list = init_skip_list(compare_keys);
+
+  // even keys only, so half of lookups miss
+  for (long i = 0; i < number_of_items; ++i) {
+    add_item_to_tail_of_list(list, init_list_item_data((void*) (2 * i), do_nothing));
+    skip_list_insert(skip_list, init_list_item_data((void*) (2 * i), do_nothing));
+  }
+
+  long list_found = 0;
+  long skip_list_found = 0;
+
+  struct timespec start, end;
+  srand(7);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < LIST_LOOKUPS; ++i) {
+    long key = rand() % (2 * number_of_items);
+    list_item_t *item = get_list_head(list)->next;
+    while (item != get_list_tail(list) && (long) get_list_item_data(item) < key) {
+      item = item->next;
+    }
+    list_found += item != get_list_tail(list) && (long) get_list_item_data(item) == key;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double list_sec = get_time_diff_sec(&start, &end);
+
+  srand(7);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (int i = 0; i < SKIP_LIST_LOOKUPS; ++i) {
+    long key = rand() % (2 * number_of_items);
+    skip_list_found += skip_list_search(skip_list, (void*) key) != NULL;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double skip_list_sec = get_time_diff_sec(&start, &end);
+
+  // same seed, so first LIST_LOOKUPS keys are the same
+  srand(7);
+  long expected_found = 0;
+  for (int i = 0; i < LIST_LOOKUPS; ++i) {
+    expected_found += skip_list_search(skip_list, (void*) (long) (rand() % (2 * number_of_items))) != NULL;
+  }
+
+  printf("%8ld items: list_t %10.1f ns/lookup, skip_list_t %6.1f ns/lookup\n", number_of_items,
+         list_sec / LIST_LOOKUPS * 1e9, skip_list_sec / SKIP_LIST_LOOKUPS * 1e9);
+
+  close_list(list);
+  close_skip_list(skip_list);
+
+  return list_found == expected_found && skip_list_found > 0 ? 0 : 1;
+}
+
+
+int main() {
+
+  int result = test_skip_list_operations();
+
+  for (long number_of_items = 1000; number_of_items <= 1000000; number_of_items *= 10) {
+    result |= bench_lookup(number_of_items);
+  }
+
+  printf(result ? "Failure\n" : "Success\n");
+
+  return result;
+}
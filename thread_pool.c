@@ -5,6 +5,21 @@
 #include <unistd.h>
 #include "list.h"
 
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_BARRIER_
+#define ST_BARRIER_
+#include "barrier.h"
+#endif
+
+#ifndef ST_LOCK_PROFILE_
+#define ST_LOCK_PROFILE_
+#include "lock_profile.h"
+#endif
+
 
 /**
  * @typedef task function to execute in thread pool
@@ -27,10 +42,11 @@ typedef struct {
     pthread_t *thread_ids;
 
     // List of tasks to execute
-    list_t *tasks_list;
+    intrusive_list_t tasks_list; // tasks_list<thread_pool_task_t>
 
-    // Mutex to sync access to add task to thread pool
-    pthread_mutex_t *add_task_mutex;
+    // Barrier to wait until all workers are set up. Woken workers
+    // may still touch it, so it lives until they are joined
+    sense_barrier_t *thread_barrier_ptr;
 
     /*
      * Resources, that are shared by workers.
@@ -40,7 +56,7 @@ typedef struct {
     // Condition to report that there is a task in list
     pthread_cond_t *thread_cond_ptr;
 
-    // Condition mutex
+    // Condition mutex, guards tasks list and is_opened
     pthread_mutex_t *thread_mutex_ptr;
 
     /*
@@ -58,6 +74,12 @@ typedef struct {
     // Tasks function to execute by worker
     task_func_t func;
 
+    // Passed to func as is
+    void *input;
+
+    // Link in list of tasks
+    list_link_t link;
+
 } thread_pool_task_t;
 
 
@@ -70,10 +92,10 @@ typedef struct thread_pool_worker_input_ {
     bool *is_pool_opened;
 
     // List with tasks to execute
-    list_t *tasks_list; // tasks_list<thread_pool_task_t>
+    intrusive_list_t *tasks_list; // tasks_list<thread_pool_task_t>
 
     // Barrier to wait until all workers are set up
-    pthread_barrier_t *thread_barrier_ptr;
+    sense_barrier_t *thread_barrier_ptr;
 
     // Condition to report that there is a task in list 
     pthread_cond_t *thread_cond_ptr;
@@ -87,7 +109,7 @@ typedef struct thread_pool_worker_input_ {
 /**
  * @function inits thread pool task to execute
  */
-thread_pool_task_t *init_thread_pool_task(task_func_t func_to_execute) {
+thread_pool_task_t *init_thread_pool_task(task_func_t func_to_execute, void *input) {
 
     thread_pool_task_t *result = (thread_pool_task_t*) malloc(sizeof(thread_pool_task_t));
 
@@ -96,6 +118,7 @@ thread_pool_task_t *init_thread_pool_task(task_func_t func_to_execute) {
     }
 
     result->func = func_to_execute;
+    result->input = input;
 
     return result;
 }
@@ -120,17 +143,19 @@ void *thread_pool_worker(void *data) {
     bool *is_pool_opened = worker_input->is_pool_opened;
     pthread_cond_t *tasks_cond = worker_input->thread_cond_ptr;
     pthread_mutex_t *tasks_mutex = worker_input->thread_mutex_ptr;
-    list_t *tasks_list = worker_input->tasks_list;
+    intrusive_list_t *tasks_list = worker_input->tasks_list;
 
     printf("#%d thread is ready\n", pthread_self());
     fflush(stdout);
 
-    pthread_barrier_wait(worker_input->thread_barrier_ptr);
+    sense_barrier_wait(worker_input->thread_barrier_ptr);
     // data is longer valid, because it was freed
 
-    while (*is_pool_opened) {
+    while (true) {
+
+        pthread_mutex_lock(tasks_mutex);
 
-        while (is_list_empty(tasks_list) && *is_pool_opened) {
+        while (is_intrusive_list_empty(tasks_list) && *is_pool_opened) {
             pthread_cond_wait(tasks_cond, tasks_mutex);
         }
 
@@ -140,16 +165,16 @@ void *thread_pool_worker(void *data) {
             break;
         }
 
-        list_item_t *list_item   = get_item_from_head_of_list(tasks_list);
-        thread_pool_task_t *task = (thread_pool_task_t*) get_list_item_data(list_item);
+        list_link_t *task_link   = remove_and_get_link_from_head(tasks_list);
+        thread_pool_task_t *task = container_of(task_link, thread_pool_task_t, link);
         task_func_t task_func    = task->func;
+        void *task_input         = task->input;
 
-        // remove task from list and free its memory
-        remove_item_from_list(tasks_list, list_item);
+        free_thread_pool_task(task);
 
         pthread_mutex_unlock(tasks_mutex);
 
-        (task_func)(NULL); // TODO: pass user input
+        (task_func)(task_input);
     }
 
     printf("#%d thread is finished\n", pthread_self());
@@ -179,33 +204,23 @@ thread_pool_t *init_thread_pool(unsigned int number_of_threads) {
         return NULL;
     }
 
-    result_thread_pool->tasks_list = init_list();
-    if (!result_thread_pool->tasks_list) {
-        free(result_thread_pool->thread_ids);
-        free(result_thread_pool);
-        return NULL;
-    }
+    init_intrusive_list(&result_thread_pool->tasks_list);
+
+    // barrier is only used on initialization phase
+    sense_barrier_t *thread_barrier = init_sense_barrier(number_of_threads + 1);
 
-    result_thread_pool->add_task_mutex = (pthread_mutex_t*) malloc(sizeof(pthread_mutex_t));
-    if (!result_thread_pool->add_task_mutex) {
-        close_list(result_thread_pool->tasks_list);
+    if (!thread_barrier) {
         free(result_thread_pool->thread_ids);
         free(result_thread_pool);
         return NULL;
     }
 
-    pthread_mutex_init(result_thread_pool->add_task_mutex, NULL);
-
-    // barrier is onle used on initialization phase
-    pthread_barrier_t thread_barrier;
-    pthread_barrier_init(&thread_barrier, NULL, number_of_threads + 1);
-
     //
     // condition and its mutex are used during all life time of thread pool
     pthread_cond_t *thread_cond = (pthread_cond_t*) malloc(sizeof(pthread_cond_t));
 
     if (!thread_cond) {
-      close_list(result_thread_pool->tasks_list);
+      close_sense_barrier(thread_barrier);
       free(result_thread_pool->thread_ids);
       free(result_thread_pool);
       return NULL;
@@ -215,7 +230,7 @@ thread_pool_t *init_thread_pool(unsigned int number_of_threads) {
 
     if (!thread_cond) {
       free(thread_cond);
-      close_list(result_thread_pool->tasks_list);
+      close_sense_barrier(thread_barrier);
       free(result_thread_pool->thread_ids);
       free(result_thread_pool);
       return NULL;
@@ -232,17 +247,17 @@ thread_pool_t *init_thread_pool(unsigned int number_of_threads) {
     if (!worker_input) {
       free(thread_cond);
       free(thread_mutex);
-      close_list(result_thread_pool->tasks_list);
+      close_sense_barrier(thread_barrier);
       free(result_thread_pool->thread_ids);
       free(result_thread_pool);
       return NULL;
     }
 
     worker_input->is_pool_opened     = &result_thread_pool->is_opened;
-    worker_input->thread_barrier_ptr = &thread_barrier;
+    worker_input->thread_barrier_ptr = thread_barrier;
     worker_input->thread_cond_ptr    = thread_cond;
     worker_input->thread_mutex_ptr   = thread_mutex;
-    worker_input->tasks_list         = result_thread_pool->tasks_list;
+    worker_input->tasks_list         = &result_thread_pool->tasks_list;
 
     // Start workers
     for (int i = 0; i < number_of_threads; ++i) {
@@ -250,8 +265,8 @@ thread_pool_t *init_thread_pool(unsigned int number_of_threads) {
     }
 
     // Wait until all workers are up
-    pthread_barrier_wait(&thread_barrier);
-    pthread_barrier_destroy(&thread_barrier);
+    sense_barrier_wait(thread_barrier);
+    result_thread_pool->thread_barrier_ptr = thread_barrier;
 
     // Each worker will shallow copy input, so we free this memory
     free(worker_input);
@@ -269,14 +284,18 @@ void destroy_thread_pool(thread_pool_t *tp) {
     return;
   }
 
-  pthread_mutex_destroy(tp->add_task_mutex);
   pthread_mutex_destroy(tp->thread_mutex_ptr);
   pthread_cond_destroy(tp->thread_cond_ptr);
-  close_list(tp->tasks_list);
 
+  // tasks left unexecuted
+  list_link_t *task_link;
+  while ((task_link = remove_and_get_link_from_head(&tp->tasks_list))) {
+    free_thread_pool_task(container_of(task_link, thread_pool_task_t, link));
+  }
+
+  close_sense_barrier(tp->thread_barrier_ptr);
   free(tp->thread_cond_ptr);
   free(tp->thread_mutex_ptr);
-  free(tp->add_task_mutex);
   free(tp->thread_ids);
   free(tp);
 }
@@ -291,8 +310,10 @@ void close_thread_pool(thread_pool_t *tp) {
         return;
     }
 
+    pthread_mutex_lock(tp->thread_mutex_ptr);
     tp->is_opened = false;
     pthread_cond_broadcast(tp->thread_cond_ptr); // wake up all awaiting workers
+    pthread_mutex_unlock(tp->thread_mutex_ptr);
 
     for (int i = 0; i < tp->number_of_threads; ++i) {
       pthread_join(*(tp->thread_ids + i), NULL);  // TODO: handle status
@@ -304,26 +325,185 @@ void close_thread_pool(thread_pool_t *tp) {
 }
 
 
-int add_task_to_thread_pool(thread_pool_t *thread_pool, void(*task_func)(void*)) {
+/**
+ * @function adds task, that gets input as its argument
+ * @brief    Tasks of one bulk-synchronous job may share sense_barrier_t
+ *           or combining_barrier_t through input to separate phases.
+ *           Pool should have at least as many workers as tasks
+ *           waiting on the barrier, otherwise they wait forever
+ */
+int add_task_with_input_to_thread_pool(thread_pool_t *thread_pool, void(*task_func)(void*), void *input) {
 
-    thread_pool_task_t *task = init_thread_pool_task(task_func);
+    thread_pool_task_t *task = init_thread_pool_task(task_func, input);
 
     if (!task) {
         return -1;
     }
 
-    // once item is removed from list, task memory will be freed
-    list_item_data_t *item_data = init_list_item_data(task, free_thread_pool_task);
+    // workers take tasks under the same mutex, they wait on
+    PROFILED_PTHREAD_MUTEX_LOCK(thread_pool->thread_mutex_ptr);
+    add_link_to_tail_of_list(&thread_pool->tasks_list, &task->link);
+    pthread_cond_signal(thread_pool->thread_cond_ptr);
+    PROFILED_PTHREAD_MUTEX_UNLOCK(thread_pool->thread_mutex_ptr);
 
-    if (!item_data) {
-        free_thread_pool_task(task);
-        return -1;
+    return 0;
+}
+
+
+int add_task_to_thread_pool(thread_pool_t *thread_pool, void(*task_func)(void*)) {
+    return add_task_with_input_to_thread_pool(thread_pool, task_func, NULL);
+}
+
+
+// Lists shorter than that are sorted by caller, tasks cost more
+#define PARALLEL_SORT_MIN_ITEMS 8192
+#define PARALLEL_SORT_MAX_RUNS 64
+
+
+/**
+ * @struct sort_run_input_t
+ */
+typedef struct {
+
+    // Run to sort or to merge other run into
+    list_t *run;
+
+    // Sorted run to merge into run, NULL if run should be sorted
+    list_t *other_run;
+
+    list_compare_func_t compare;
+
+    // Runs left in current step, caller sleeps until it is 0
+    futex_word_t *number_of_pending_runs;
+
+} sort_run_input_t;
+
+
+static void sort_run_task_func(void *input) {
+
+    sort_run_input_t *run_input = (sort_run_input_t*) input;
+
+    if (run_input->other_run) {
+        merge_sorted_lists(run_input->run, run_input->other_run, run_input->compare);
+    } else {
+        sort_list(run_input->run, run_input->compare);
     }
 
-    pthread_mutex_lock(thread_pool->add_task_mutex);
-    add_item_to_tail_of_list(thread_pool->tasks_list, item_data);
-    pthread_cond_signal(thread_pool->thread_cond_ptr);
-    pthread_mutex_unlock(thread_pool->add_task_mutex);
+    // input may be reused by caller as soon as counter drops
+    futex_word_t *number_of_pending_runs = run_input->number_of_pending_runs;
+
+    if (atomic_fetch_sub(number_of_pending_runs, 1) == 1) {
+        futex_wake(number_of_pending_runs, 1);
+    }
+}
+
+
+/**
+ * @function runs sort step in pool or by caller, if task can not be added
+ */
+static void start_sort_run(thread_pool_t *thread_pool, sort_run_input_t *run_input) {
+    if (add_task_with_input_to_thread_pool(thread_pool, &sort_run_task_func, run_input)) {
+        sort_run_task_func(run_input);
+    }
+}
+
+
+static void wait_for_sort_runs(futex_word_t *number_of_pending_runs) {
+
+    uint32_t pending;
+
+    while ((pending = atomic_load(number_of_pending_runs))) {
+        futex_wait(number_of_pending_runs, pending);
+    }
+}
+
+
+/**
+ * @function sorts list with workers of pool, equal items keep their order
+ * @brief    List is split into a run per worker, runs are sorted in
+ *           parallel and then merged pairwise, half as many merges
+ *           each step. Caller waits, so it may not be a worker itself
+ * @returns  0 on success, -1 if error
+ */
+int parallel_sort_list(thread_pool_t *thread_pool, list_t *list, list_compare_func_t compare) {
+
+    size_t number_of_items = 0;
+
+    for (list_item_t *item = list->head->next; item != list->tail; item = item->next) {
+        ++number_of_items;
+    }
+
+    size_t number_of_runs = thread_pool->number_of_threads;
+    if (number_of_runs > PARALLEL_SORT_MAX_RUNS) {
+        number_of_runs = PARALLEL_SORT_MAX_RUNS;
+    }
+
+    if (number_of_runs < 2 || number_of_items < PARALLEL_SORT_MIN_ITEMS) {
+        sort_list(list, compare);
+        return 0;
+    }
+
+    // run r starts at item with index r * number_of_items / number_of_runs
+    list_item_t *run_heads[PARALLEL_SORT_MAX_RUNS];
+    list_item_t *item = list->head->next;
+
+    for (size_t index = 0, run = 0; run < number_of_runs; ++index, item = item->next) {
+        if (index == run * number_of_items / number_of_runs) {
+            run_heads[run++] = item;
+        }
+    }
+
+    list_t *runs[PARALLEL_SORT_MAX_RUNS];
+    runs[0] = list;
+
+    for (size_t run = 1; run < number_of_runs; ++run) {
+
+        runs[run] = list_split_at(runs[run - 1], run_heads[run]);
+
+        if (!runs[run]) {
+
+            // glue back what has been split
+            for (size_t i = run - 1; i > 0; --i) {
+                list_concat(runs[i - 1], runs[i]);
+            }
+
+            return -1;
+        }
+    }
+
+    sort_run_input_t run_inputs[PARALLEL_SORT_MAX_RUNS];
+    futex_word_t number_of_pending_runs;
+
+    atomic_init(&number_of_pending_runs, number_of_runs);
+
+    for (size_t run = 0; run < number_of_runs; ++run) {
+        run_inputs[run] = (sort_run_input_t) { runs[run], NULL, compare, &number_of_pending_runs };
+        start_sort_run(thread_pool, run_inputs + run);
+    }
+
+    wait_for_sort_runs(&number_of_pending_runs);
+
+    for (size_t step = 1; step < number_of_runs; step *= 2) {
+
+        size_t number_of_merges = 0;
+        for (size_t run = 0; run + step < number_of_runs; run += 2 * step) {
+            ++number_of_merges;
+        }
+
+        atomic_store(&number_of_pending_runs, number_of_merges);
+
+        // left run keeps its items before equal items of right one
+        for (size_t run = 0; run + step < number_of_runs; run += 2 * step) {
+            run_inputs[run] = (sort_run_input_t) { runs[run], runs[run + step], compare, &number_of_pending_runs };
+            start_sort_run(thread_pool, run_inputs + run);
+        }
+
+        wait_for_sort_runs(&number_of_pending_runs);
+
+        for (size_t run = 0; run + step < number_of_runs; run += 2 * step) {
+            close_list(runs[run + step]);
+        }
+    }
 
     return 0;
 }
@@ -341,6 +521,84 @@ void test_task_func_2(void *input) {
 }
 
 
+#define TEST_PHASE_TASKS 4
+#define TEST_PHASES 3
+
+
+typedef struct {
+    combining_barrier_t *barrier;
+    unsigned int task_index;
+} test_phase_input_t;
+
+
+/**
+ * @function no task starts next phase until all tasks finish current one
+ */
+void test_phase_task_func(void *input) {
+
+    test_phase_input_t *phase_input = (test_phase_input_t*) input;
+
+    for (int phase = 0; phase < TEST_PHASES; ++phase) {
+        printf("Task #%u finished phase %d\n", phase_input->task_index, phase);
+        fflush(stdout);
+
+        combining_barrier_wait(phase_input->barrier, phase_input->task_index);
+    }
+}
+
+
+#define TEST_SORT_ITEMS 1000000
+
+
+static void test_sort_free_func(void *data) {
+    (void) data;
+}
+
+
+static int test_sort_compare(void *first, void *second) {
+    // low 20 bits keep insertion order to check stability
+    long first_key = (long) first >> 20;
+    long second_key = (long) second >> 20;
+    return first_key < second_key ? -1 : first_key > second_key;
+}
+
+
+/**
+ * @function sorts list of random keys on pool and checks order
+ */
+int test_parallel_sort(thread_pool_t *tp) {
+
+    list_t *list = init_list();
+
+    srand(42);
+    for (long i = 0; i < TEST_SORT_ITEMS; ++i) {
+        long key = rand() % 1000;
+        add_item_to_tail_of_list(list, init_list_item_data((void*) (key << 20 | i), &test_sort_free_func));
+    }
+
+    int result = parallel_sort_list(tp, list, &test_sort_compare);
+    long number_of_items = 0;
+
+    for (list_item_t *item = list->head->next; item != list->tail; item = item->next) {
+        ++number_of_items;
+        if (item->prev != list->head && (long) get_list_item_data(item->prev) > (long) get_list_item_data(item)) {
+            result = -1;
+        }
+    }
+
+    if (number_of_items != TEST_SORT_ITEMS || list->last_item != list->tail->prev) {
+        result = -1;
+    }
+
+    close_list(list);
+
+    printf("test_parallel_sort: %s\n", result ? "Failure" : "Success");
+    fflush(stdout);
+
+    return result;
+}
+
+
 int main() {
 
     thread_pool_t *tp = init_thread_pool(10);
@@ -350,9 +608,26 @@ int main() {
     add_task_to_thread_pool(tp, &test_task_func_2);
     add_task_to_thread_pool(tp, &test_task_func_2);
 
+    combining_barrier_t *phase_barrier = init_combining_barrier(TEST_PHASE_TASKS);
+    test_phase_input_t phase_inputs[TEST_PHASE_TASKS];
+
+    for (unsigned int i = 0; i < TEST_PHASE_TASKS; ++i) {
+        phase_inputs[i].barrier = phase_barrier;
+        phase_inputs[i].task_index = i;
+        add_task_with_input_to_thread_pool(tp, &test_phase_task_func, phase_inputs + i);
+    }
+
     sleep(3);  // sleep for 3 seconds
+
+    int result = test_parallel_sort(tp);
+
     close_thread_pool(tp);
+    close_combining_barrier(phase_barrier);
 
-    return 0;
+#ifdef LOCK_PROFILING
+    lock_profile_dump(stdout);
+#endif
+
+    return result ? 1 : 0;
 }
 
@@ -9,6 +9,21 @@
 #include "list.h"
 #endif
 
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_ADAPTIVE_MUTEX_
+#define ST_ADAPTIVE_MUTEX_
+#include "adaptive_mutex.h"
+#endif
+
+#ifndef ST_LOCK_PROFILE_
+#define ST_LOCK_PROFILE_
+#include "lock_profile.h"
+#endif
+
 #ifndef ST_TS_LIST_
 #define ST_TS_LIST_
 #include "ts_list.h"
@@ -41,9 +56,9 @@ ts_list_t *init_ts_list() {
     return NULL;
   }
 
-  pthread_mutex_init(&ts_list->add_head_mutex, NULL);
-  pthread_mutex_init(&ts_list->add_tail_mutex, NULL);
-  pthread_mutex_init(&ts_list->remove_mutex, NULL);
+  adaptive_mutex_init(&ts_list->add_head_mutex);
+  adaptive_mutex_init(&ts_list->add_tail_mutex);
+  adaptive_mutex_init(&ts_list->remove_mutex);
 
   ts_list->origin_list = list;
 
@@ -52,23 +67,23 @@ ts_list_t *init_ts_list() {
 
 
 void lock_all_mutexes(ts_list_t *list) {
-  pthread_mutex_lock(&list->add_head_mutex);
-  pthread_mutex_lock(&list->add_tail_mutex);
-  pthread_mutex_lock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->remove_mutex);
 }
 
 
 void unlock_all_mutexes(ts_list_t *list) {
-  pthread_mutex_unlock(&list->add_head_mutex);
-  pthread_mutex_unlock(&list->add_tail_mutex);
-  pthread_mutex_unlock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->remove_mutex);
 }
 
 
 void destroy_all_mutexes(ts_list_t *list) {
-  pthread_mutex_destroy(&list->add_head_mutex);
-  pthread_mutex_destroy(&list->add_tail_mutex);
-  pthread_mutex_destroy(&list->remove_mutex);
+  adaptive_mutex_destroy(&list->add_head_mutex);
+  adaptive_mutex_destroy(&list->add_tail_mutex);
+  adaptive_mutex_destroy(&list->remove_mutex);
 }
 
 
@@ -86,9 +101,9 @@ void TS_close_list(ts_list_t *list) {
 
 list_item_t *TS_add_item_to_head_of_list(ts_list_t *list, list_item_data_t *item_data) {
 
-  pthread_mutex_lock(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
   list_item_t *new_item = add_item_to_head_of_list(list->origin_list, item_data);
-  pthread_mutex_unlock(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
 
   return new_item;
 }
@@ -98,11 +113,11 @@ list_item_t *TS_add_item_to_tail_of_list(ts_list_t *list, list_item_data_t *item
 
   list_item_t *new_item;
 
-  pthread_mutex_lock(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
 
   if (is_list_empty(list->origin_list)) {
 
-    pthread_mutex_lock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
 
     //
     // No one can add item to list when this block runs
@@ -113,13 +128,13 @@ list_item_t *TS_add_item_to_tail_of_list(ts_list_t *list, list_item_data_t *item
       new_item = add_item_to_tail_of_list(list->origin_list, item_data);
     }
 
-    pthread_mutex_unlock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
 
   } else {
     new_item = add_item_to_tail_of_list(list->origin_list, item_data);
   }
 
-  pthread_mutex_unlock(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
 
   return new_item;
 }
@@ -143,25 +158,25 @@ int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item) {
   //
   int (*handle_when_first_item) (ts_list_t*, list_item_t*) = LAMBDA(int _(ts_list_t *list, list_item_t *item) {
     int result = remove_item_from_list(list->origin_list, searched_item);
-    pthread_mutex_unlock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
     return result;
   });
 
   int (*handle_when_last_item) (ts_list_t*, list_item_t*) = LAMBDA(int _(ts_list_t *list, list_item_t *item) {
     int result = remove_item_from_list(list->origin_list, searched_item);
-    pthread_mutex_unlock(&list->add_tail_mutex);
+    PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
     return result;
   });
 
-  pthread_mutex_lock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->remove_mutex);
 
   int is_first_item = c_is_first_item(list, searched_item);
   int is_last_item  = c_is_last_item(list, searched_item);
 
   if (is_first_item && is_last_item) {
 
-    pthread_mutex_lock(&list->add_head_mutex);
-    pthread_mutex_lock(&list->add_tail_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
 
     // Test if this condition is still true
     // to determine more efficient way to unlock add mutexes
@@ -171,17 +186,17 @@ int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item) {
     if (new_is_first_item && new_is_last_item) {
 
       result = remove_item_from_list(list->origin_list, searched_item);
-      pthread_mutex_unlock(&list->add_tail_mutex);
-      pthread_mutex_unlock(&list->add_head_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
 
     } else if (new_is_first_item) {
 
-      pthread_mutex_unlock(&list->add_tail_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
       result = handle_when_first_item(list, searched_item);
 
     } else if (new_is_last_item) {
 
-      pthread_mutex_unlock(&list->add_head_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
       result = handle_when_last_item(list, searched_item);
 
     } else {
@@ -191,7 +206,7 @@ int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item) {
     }
   } else if (is_first_item) {
 
-    pthread_mutex_lock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
 
     // Test if this condition is still true
     // to determine more efficient way to unlock add mutexes
@@ -200,12 +215,12 @@ int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item) {
     if (new_is_first_item) {
       result = handle_when_first_item(list, searched_item);
     } else {
-      pthread_mutex_unlock(&list->add_head_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
       result = remove_item_from_list(list->origin_list, searched_item);
     }
   } else if (is_last_item) {
 
-    pthread_mutex_lock(&list->add_tail_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
 
     // Test if this condition is still true
     // to determine more efficient way to unlock add mutexes
@@ -214,14 +229,14 @@ int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item) {
     if (new_is_last_item) {
       result = handle_when_last_item(list, searched_item);
     } else {
-      pthread_mutex_unlock(&list->add_tail_mutex);
+      PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
       result = remove_item_from_list(list->origin_list, searched_item);
     }
   } else {
     result = remove_item_from_list(list->origin_list, searched_item);
   }
 
-  pthread_mutex_unlock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->remove_mutex);
 
   return result;
 }
@@ -242,19 +257,20 @@ void *TS_remove_and_get_item_from_head(ts_list_t *list) {
 
   void *result;
 
-  pthread_mutex_lock(&list->remove_mutex);
-  pthread_mutex_lock(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
 
+  // last_item belongs to tail side, it is touched only under tail mutex
   if (is_one_item_list(list)) {
-    pthread_mutex_lock(&list->add_tail_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
     result = remove_and_get_item_data_from_head(list->origin_list);
-    pthread_mutex_unlock(&list->add_tail_mutex);
+    PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
   } else {
-    result = remove_and_get_item_data_from_head(list->origin_list);
+    result = remove_and_get_item_data_from_head_keep_last(list->origin_list);
   }
 
-  pthread_mutex_unlock(&list->add_head_mutex);
-  pthread_mutex_unlock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->remove_mutex);
 
   return result;
 }
@@ -264,19 +280,19 @@ list_item_t *TS_remove_and_get_item_from_tail(ts_list_t *list) {
 
   void *result;
 
-  pthread_mutex_lock(&list->remove_mutex);
-  pthread_mutex_lock(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_tail_mutex);
 
   if (is_one_item_list(list)) {
-    pthread_mutex_lock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_LOCK(&list->add_head_mutex);
     result = remove_and_get_item_data_from_head(list->origin_list);
-    pthread_mutex_unlock(&list->add_head_mutex);
+    PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_head_mutex);
   } else {
     result = remove_and_get_item_data_from_head(list->origin_list);
   }
 
-  pthread_mutex_unlock(&list->add_tail_mutex);
-  pthread_mutex_unlock(&list->remove_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->add_tail_mutex);
+  PROFILED_ADAPTIVE_MUTEX_UNLOCK(&list->remove_mutex);
 
   return result;
 }
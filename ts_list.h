@@ -1,8 +1,8 @@
 typedef struct {
 
-  pthread_mutex_t add_head_mutex;
-  pthread_mutex_t add_tail_mutex;
-  pthread_mutex_t remove_mutex;
+  adaptive_mutex_t add_head_mutex;
+  adaptive_mutex_t add_tail_mutex;
+  adaptive_mutex_t remove_mutex;
 
   list_t *origin_list;
 
@@ -24,3 +24,6 @@ list_item_t *TS_add_item_to_tail_of_list(ts_list_t *list, list_item_data_t *item
 int TS_remove_item_from_list(ts_list_t *list, list_item_t *searched_item);
 
 
+
+
+void *TS_remove_and_get_item_from_head(ts_list_t *list);
@@ -5,6 +5,16 @@
 #include "list.h"
 #endif
 
+#ifndef ST_FUTEX_
+#define ST_FUTEX_
+#include "futex.h"
+#endif
+
+#ifndef ST_ADAPTIVE_MUTEX_
+#define ST_ADAPTIVE_MUTEX_
+#include "adaptive_mutex.h"
+#endif
+
 #ifndef ST_TS_LIST_
 #define ST_TS_LIST_
 #include "ts_list.h"
@@ -0,0 +1,282 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+
+/*
+ * Typed list
+ *
+ * DEFINE_LIST(name, T, dtor) generates doubly linked list, that keeps
+ * T inline in its items, so item and its data take one allocation and
+ * data is read without indirection. dtor is function or function-like
+ * macro, that gets T*, called directly on remove, clean and close, so
+ * compiler may inline it. LIST_NO_DTOR is for data, that owns nothing.
+ * Operations are the ones of list.h, prefixed by name:
+ *
+ *     DEFINE_LIST(long_list, long, LIST_NO_DTOR)
+ *
+ *     long_list_t *list = long_list_init();
+ *     long_list_add_to_tail(list, 42);
+ *
+ *     for_each_in_typed_list(list, item) {
+ *       sum += *long_list_data(item);
+ *     }
+ *
+ * Unlike remove_and_get_item_data_from_head, name_remove_head moves
+ * data out to caller and does not call dtor.
+ */
+
+
+#define LIST_NO_DTOR(data_ptr) ((void) (data_ptr))
+
+
+/**
+ * @function iterates over items of typed list, current item may not be removed
+ */
+#define for_each_in_typed_list(list, item) \
+  for (__typeof__((list)->head) item = (list)->head->next; item != (list)->tail; item = item->next)
+
+
+#define DEFINE_LIST(name, T, dtor)                                                    \
+typedef struct name##_item_t_ {                                                       \
+  struct name##_item_t_ *prev;                                                        \
+  struct name##_item_t_ *next;                                                        \
+  T data;                                                                             \
+} name##_item_t;                                                                      \
+                                                                                      \
+typedef struct {                                                                      \
+  name##_item_t *head;                                                                \
+  name##_item_t *tail;                                                                \
+} name##_t;                                                                           \
+                                                                                      \
+static inline name##_t *name##_init() {                                               \
+  name##_t *list = (name##_t*) malloc(sizeof(name##_t));                              \
+  name##_item_t *head = (name##_item_t*) malloc(sizeof(name##_item_t));               \
+  name##_item_t *tail = (name##_item_t*) malloc(sizeof(name##_item_t));               \
+  if (!list || !head || !tail) {                                                      \
+    free(list);                                                                       \
+    free(head);                                                                       \
+    free(tail);                                                                       \
+    return NULL;                                                                      \
+  }                                                                                   \
+  head->prev = NULL;                                                                  \
+  head->next = tail;                                                                  \
+  tail->prev = head;                                                                  \
+  tail->next = NULL;                                                                  \
+  list->head = head;                                                                  \
+  list->tail = tail;                                                                  \
+  return list;                                                                        \
+}                                                                                     \
+                                                                                      \
+static inline int name##_is_empty(name##_t *list) {                                   \
+  return list->head->next == list->tail;                                              \
+}                                                                                     \
+                                                                                      \
+static inline T *name##_data(name##_item_t *item) {                                   \
+  return &item->data;                                                                 \
+}                                                                                     \
+                                                                                      \
+static inline name##_item_t *name##_first(name##_t *list) {                           \
+  return name##_is_empty(list) ? NULL : list->head->next;                             \
+}                                                                                     \
+                                                                                      \
+static inline name##_item_t *name##_last(name##_t *list) {                            \
+  return name##_is_empty(list) ? NULL : list->tail->prev;                             \
+}                                                                                     \
+                                                                                      \
+static inline void name##_link(name##_item_t *item,                                   \
+                               name##_item_t *prev_item, name##_item_t *next_item) {  \
+  item->prev = prev_item;                                                             \
+  item->next = next_item;                                                             \
+  prev_item->next = item;                                                             \
+  next_item->prev = item;                                                             \
+}                                                                                     \
+                                                                                      \
+static inline name##_item_t *name##_add_to_head(name##_t *list, T data) {             \
+  name##_item_t *item = (name##_item_t*) malloc(sizeof(name##_item_t));               \
+  if (!item) {                                                                        \
+    return NULL;                                                                      \
+  }                                                                                   \
+  item->data = data;                                                                  \
+  name##_link(item, list->head, list->head->next);                                    \
+  return item;                                                                        \
+}                                                                                     \
+                                                                                      \
+static inline name##_item_t *name##_add_to_tail(name##_t *list, T data) {             \
+  name##_item_t *item = (name##_item_t*) malloc(sizeof(name##_item_t));               \
+  if (!item) {                                                                        \
+    return NULL;                                                                      \
+  }                                                                                   \
+  item->data = data;                                                                  \
+  name##_link(item, list->tail->prev, list->tail);                                    \
+  return item;                                                                        \
+}                                                                                     \
+                                                                                      \
+/* unlinks item and frees it without destructor */                                    \
+static inline void name##_unlink(name##_item_t *item) {                               \
+  item->prev->next = item->next;                                                      \
+  item->next->prev = item->prev;                                                      \
+  free(item);                                                                         \
+}                                                                                     \
+                                                                                      \
+static inline int name##_remove(name##_t *list, name##_item_t *item) {                \
+  if (!item || item == list->head || item == list->tail) {                            \
+    return -1;                                                                        \
+  }                                                                                   \
+  dtor(&item->data);                                                                  \
+  name##_unlink(item);                                                                \
+  return 0;                                                                           \
+}                                                                                     \
+                                                                                      \
+/* moves data out to caller, destructor is not called */                              \
+static inline int name##_remove_head(name##_t *list, T *data) {                       \
+  if (name##_is_empty(list)) {                                                        \
+    return -1;                                                                        \
+  }                                                                                   \
+  *data = list->head->next->data;                                                     \
+  name##_unlink(list->head->next);                                                    \
+  return 0;                                                                           \
+}                                                                                     \
+                                                                                      \
+static inline int name##_remove_tail(name##_t *list, T *data) {                       \
+  if (name##_is_empty(list)) {                                                        \
+    return -1;                                                                        \
+  }                                                                                   \
+  *data = list->tail->prev->data;                                                     \
+  name##_unlink(list->tail->prev);                                                    \
+  return 0;                                                                           \
+}                                                                                     \
+                                                                                      \
+static inline void name##_clean(name##_t *list) {                                     \
+  name##_item_t *item = list->head->next;                                             \
+  while (item != list->tail) {                                                        \
+    name##_item_t *next_item = item->next;                                            \
+    dtor(&item->data);                                                                \
+    free(item);                                                                       \
+    item = next_item;                                                                 \
+  }                                                                                   \
+  list->head->next = list->tail;                                                      \
+  list->tail->prev = list->head;                                                      \
+}                                                                                     \
+                                                                                      \
+static inline void name##_close(name##_t *list) {                                     \
+  name##_clean(list);                                                                 \
+  free(list->head);                                                                   \
+  free(list->tail);                                                                   \
+  free(list);                                                                         \
+}                                                                                     \
+                                                                                      \
+static inline void name##_reverse(name##_t *list) {                                   \
+  name##_item_t *item = list->head;                                                   \
+  while (item) {                                                                      \
+    name##_item_t *next_item = item->next;                                            \
+    item->next = item->prev;                                                          \
+    item->prev = next_item;                                                           \
+    item = next_item;                                                                 \
+  }                                                                                   \
+  name##_item_t *head = list->head;                                                   \
+  list->head = list->tail;                                                            \
+  list->tail = head;                                                                  \
+}                                                                                     \
+                                                                                      \
+static inline void name##_splice_tail(name##_t *destination, name##_t *source) {      \
+  if (name##_is_empty(source)) {                                                      \
+    return;                                                                           \
+  }                                                                                   \
+  name##_item_t *first_item = source->head->next;                                     \
+  name##_item_t *last_item = source->tail->prev;                                      \
+  source->head->next = source->tail;                                                  \
+  source->tail->prev = source->head;                                                  \
+  first_item->prev = destination->tail->prev;                                         \
+  destination->tail->prev->next = first_item;                                         \
+  last_item->next = destination->tail;                                                \
+  destination->tail->prev = last_item;                                                \
+}                                                                                     \
+                                                                                      \
+static inline name##_t *name##_concat(name##_t *first, name##_t *second) {            \
+  name##_splice_tail(first, second);                                                  \
+  name##_close(second);                                                               \
+  return first;                                                                       \
+}                                                                                     \
+                                                                                      \
+static inline name##_t *name##_split_at(name##_t *list, name##_item_t *item) {        \
+  name##_t *new_list = name##_init();                                                 \
+  if (!new_list || !item || item == list->head || item == list->tail) {               \
+    return new_list;                                                                  \
+  }                                                                                   \
+  name##_item_t *prev_item = item->prev;                                              \
+  name##_item_t *last_item = list->tail->prev;                                        \
+  prev_item->next = list->tail;                                                       \
+  list->tail->prev = prev_item;                                                       \
+  item->prev = new_list->head;                                                        \
+  new_list->head->next = item;                                                        \
+  last_item->next = new_list->tail;                                                   \
+  new_list->tail->prev = last_item;                                                   \
+  return new_list;                                                                    \
+}                                                                                     \
+                                                                                      \
+static inline name##_t *name##_steal_all(name##_t *list) {                            \
+  name##_t *new_list = name##_init();                                                 \
+  if (new_list) {                                                                     \
+    name##_splice_tail(new_list, list);                                               \
+  }                                                                                   \
+  return new_list;                                                                    \
+}                                                                                     \
+                                                                                      \
+/* stable bottom-up merge sort, same as sort_list */                                  \
+static inline void name##_sort(name##_t *list, int (*compare)(const T*, const T*)) {  \
+  if (name##_is_empty(list)) {                                                        \
+    return;                                                                           \
+  }                                                                                   \
+  name##_item_t *chain = list->head->next;                                            \
+  name##_item_t *chain_tail = list->tail->prev;                                       \
+  chain_tail->next = NULL;                                                            \
+  for (size_t run_size = 1;; run_size *= 2) {                                         \
+    name##_item_t *left = chain;                                                      \
+    size_t number_of_merges = 0;                                                      \
+    chain = NULL;                                                                     \
+    chain_tail = NULL;                                                                \
+    while (left) {                                                                    \
+      ++number_of_merges;                                                             \
+      name##_item_t *right = left;                                                    \
+      size_t left_size = 0;                                                           \
+      while (left_size < run_size && right) {                                         \
+        ++left_size;                                                                  \
+        right = right->next;                                                          \
+      }                                                                               \
+      size_t right_size = run_size;                                                   \
+      while (left_size || (right_size && right)) {                                    \
+        name##_item_t *item;                                                          \
+        if (!left_size) {                                                             \
+          item = right;                                                               \
+          right = right->next;                                                        \
+          --right_size;                                                               \
+        } else if (!right_size || !right ||                                           \
+                   (*compare)(&left->data, &right->data) <= 0) {                      \
+          item = left;                                                                \
+          left = left->next;                                                          \
+          --left_size;                                                                \
+        } else {                                                                      \
+          item = right;                                                               \
+          right = right->next;                                                        \
+          --right_size;                                                               \
+        }                                                                             \
+        if (chain_tail) {                                                             \
+          chain_tail->next = item;                                                    \
+        } else {                                                                      \
+          chain = item;                                                               \
+        }                                                                             \
+        item->prev = chain_tail;                                                      \
+        chain_tail = item;                                                            \
+      }                                                                               \
+      left = right;                                                                   \
+    }                                                                                 \
+    chain_tail->next = NULL;                                                          \
+    if (number_of_merges <= 1) {                                                      \
+      break;                                                                          \
+    }                                                                                 \
+  }                                                                                   \
+  list->head->next = chain;                                                           \
+  chain->prev = list->head;                                                           \
+  chain_tail->next = list->tail;                                                      \
+  list->tail->prev = chain_tail;                                                      \
+}
@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_TYPED_LIST_
+#define ST_TYPED_LIST_
+#include "typed_list.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int NUMBER_OF_ITEMS = 1000000;
+const int NUMBER_OF_ROUNDS = 5;
+
+
+typedef struct {
+  long key;
+  long *number_of_destroyed;
+} counted_t;
+
+
+static inline void destroy_counted(counted_t *counted) {
+  ++*counted->number_of_destroyed;
+}
+
+
+DEFINE_LIST(long_list, long, LIST_NO_DTOR)
+DEFINE_LIST(counted_list, counted_t, destroy_counted)
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void do_nothing(void *data) {
+  (void) data;
+}
+
+
+static int compare_counted(const counted_t *first, const counted_t *second) {
+  return first->key < second->key ? -1 : first->key > second->key;
+}
+
+
+/**
+ * @function checks order after sort, split and concat, and that every
+ *           removed or cleaned item is destroyed exactly once
+ * @returns  0 on success
+ */
+int test_typed_list() {
+
+  long number_of_destroyed = 0;
+  counted_list_t *list = counted_list_init();
+
+  srand(42);
+  for (long i = 0; i < 1000; ++i) {
+    counted_list_add_to_tail(list, (counted_t) { rand() % 100, &number_of_destroyed });
+  }
+
+  counted_list_sort(list, compare_counted);
+
+  // split in the middle and glue back
+  counted_list_item_t *middle = counted_list_first(list);
+  for (int i = 0; i < 500; ++i) {
+    middle = middle->next;
+  }
+  list = counted_list_concat(list, counted_list_split_at(list, middle));
+
+  int is_sorted = 1;
+  long length = 0;
+  for_each_in_typed_list(list, item) {
+    is_sorted = is_sorted && (item->prev == list->head || item->prev->data.key <= item->data.key);
+    ++length;
+  }
+
+  counted_t moved_out;
+  counted_list_remove_head(list, &moved_out);
+  counted_list_remove(list, counted_list_last(list));
+  counted_list_close(list);
+
+  int result = is_sorted && length == 1000 && number_of_destroyed == 999 ? 0 : 1;
+
+  printf("test_typed_list: %s\n", result ? "Failure" : "Success");
+
+  return result;
+}
+
+
+/**
+ * @function fills list_t and typed list, walks and empties them round after round
+ * @returns  0 if both have seen the same payloads
+ */
+int bench_insert_traverse_remove() {
+
+  double list_sec[3] = { 0, 0, 0 };
+  double typed_list_sec[3] = { 0, 0, 0 };
+  long list_checksum = 0;
+  long typed_list_checksum = 0;
+
+  list_t *list = init_list();
+  long_list_t *typed_list = long_list_init();
+
+  for (int round = 0; round < NUMBER_OF_ROUNDS; ++round) {
+
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < NUMBER_OF_ITEMS; ++i) {
+      add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    list_sec[0] += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (list_item_t *item = get_list_head(list)->next; item != get_list_tail(list); item = item->next) {
+      list_checksum += (long) get_list_item_data(item);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    list_sec[1] += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!is_list_empty(list)) {
+      remove_item_from_list(list, get_item_from_head_of_list(list));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    list_sec[2] += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < NUMBER_OF_ITEMS; ++i) {
+      long_list_add_to_tail(typed_list, i);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    typed_list_sec[0] += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for_each_in_typed_list(typed_list, item) {
+      typed_list_checksum += *long_list_data(item);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    typed_list_sec[1] += get_time_diff_sec(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!long_list_is_empty(typed_list)) {
+      long_list_remove(typed_list, long_list_first(typed_list));
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    typed_list_sec[2] += get_time_diff_sec(&start, &end);
+  }
+
+  close_list(list);
+  long_list_close(typed_list);
+
+  double operations = (double) NUMBER_OF_ITEMS * NUMBER_OF_ROUNDS;
+  const char *names[3] = { "insert:  ", "traverse:", "remove:  " };
+
+  for (int i = 0; i < 3; ++i) {
+    printf("%s list_t %6.2f ns/item, typed list %6.2f ns/item\n", names[i],
+           list_sec[i] / operations * 1e9, typed_list_sec[i] / operations * 1e9);
+  }
+
+  return list_checksum == typed_list_checksum ? 0 : 1;
+}
+
+
+int main() {
+
+  int result = test_typed_list();
+  result |= bench_insert_traverse_remove();
+
+  printf(result ? "Failure\n" : "Success\n");
+
+  return result;
+}
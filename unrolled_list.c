@@ -0,0 +1,330 @@
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef ST_UNROLLED_LIST_
+#define ST_UNROLLED_LIST_
+#include "unrolled_list.h"
+#endif
+
+#define UNROLLED_CACHE_LINE_SIZE 64
+
+
+/**
+ * @function Initializes empty chunk
+ * @returns pointer to the created chunk or NULL if error
+ */
+static unrolled_chunk_t *init_unrolled_chunk() {
+
+  unrolled_chunk_t *chunk = (unrolled_chunk_t*) aligned_alloc(UNROLLED_CACHE_LINE_SIZE, sizeof(unrolled_chunk_t));
+  if (!chunk) {
+    return NULL;
+  }
+
+  chunk->prev = NULL;
+  chunk->next = NULL;
+  chunk->count = 0;
+
+  return chunk;
+}
+
+
+/**
+ * @function Links new chunk after given one, NULL means before head
+ */
+static void link_chunk_after(unrolled_list_t *list, unrolled_chunk_t *prev_chunk, unrolled_chunk_t *chunk) {
+
+  unrolled_chunk_t *next_chunk = prev_chunk ? prev_chunk->next : list->head;
+
+  chunk->prev = prev_chunk;
+  chunk->next = next_chunk;
+
+  if (prev_chunk) {
+    prev_chunk->next = chunk;
+  } else {
+    list->head = chunk;
+  }
+
+  if (next_chunk) {
+    next_chunk->prev = chunk;
+  } else {
+    list->tail = chunk;
+  }
+}
+
+
+/**
+ * @function Unlinks chunk and frees its memory
+ */
+static void remove_chunk(unrolled_list_t *list, unrolled_chunk_t *chunk) {
+
+  if (chunk->prev) {
+    chunk->prev->next = chunk->next;
+  } else {
+    list->head = chunk->next;
+  }
+
+  if (chunk->next) {
+    chunk->next->prev = chunk->prev;
+  } else {
+    list->tail = chunk->prev;
+  }
+
+  free(chunk);
+}
+
+
+/**
+ * @function Moves all payloads of source to the end of destination
+ *           and removes source
+ */
+static void merge_chunks(unrolled_list_t *list, unrolled_chunk_t *destination, unrolled_chunk_t *source) {
+  memcpy(destination->items + destination->count, source->items, source->count * sizeof(void*));
+  destination->count += source->count;
+  remove_chunk(list, source);
+}
+
+
+/**
+ * @function Initializes empty unrolled list
+ * @returns pointer to the created list or NULL if error
+ */
+unrolled_list_t *init_unrolled_list() {
+
+  unrolled_list_t *list = (unrolled_list_t*) malloc(sizeof(unrolled_list_t));
+  if (!list) {
+    return NULL;
+  }
+
+  list->head = NULL;
+  list->tail = NULL;
+  list->length = 0;
+
+  return list;
+}
+
+
+/**
+ * @function Frees chunks and list itself
+ * @brief Calls free_func for every payload, if it is not NULL
+ */
+void close_unrolled_list(unrolled_list_t *list, void (*free_func)(void*)) {
+
+  unrolled_chunk_t *chunk = list->head;
+
+  while (chunk) {
+
+    unrolled_chunk_t *next_chunk = chunk->next;
+
+    if (free_func) {
+      for (size_t i = 0; i < chunk->count; ++i) {
+        (*free_func)(chunk->items[i]);
+      }
+    }
+
+    free(chunk);
+    chunk = next_chunk;
+  }
+
+  free(list);
+}
+
+
+/**
+ * @returns 0 on success, -1 if error
+ */
+int unrolled_list_push_head(unrolled_list_t *list, void *data) {
+
+  unrolled_chunk_t *chunk = list->head;
+
+  if (!chunk || chunk->count == UNROLLED_CHUNK_CAPACITY) {
+
+    chunk = init_unrolled_chunk();
+    if (!chunk) {
+      return -1;
+    }
+
+    link_chunk_after(list, NULL, chunk);
+  }
+
+  memmove(chunk->items + 1, chunk->items, chunk->count * sizeof(void*));
+  chunk->items[0] = data;
+  ++chunk->count;
+  ++list->length;
+
+  return 0;
+}
+
+
+/**
+ * @returns 0 on success, -1 if error
+ */
+int unrolled_list_push_tail(unrolled_list_t *list, void *data) {
+
+  unrolled_chunk_t *chunk = list->tail;
+
+  if (!chunk || chunk->count == UNROLLED_CHUNK_CAPACITY) {
+
+    chunk = init_unrolled_chunk();
+    if (!chunk) {
+      return -1;
+    }
+
+    link_chunk_after(list, list->tail, chunk);
+  }
+
+  chunk->items[chunk->count++] = data;
+  ++list->length;
+
+  return 0;
+}
+
+
+/**
+ * @returns first payload or NULL if list is empty
+ */
+void *unrolled_list_pop_head(unrolled_list_t *list) {
+
+  unrolled_chunk_t *chunk = list->head;
+
+  if (!chunk) {
+    return NULL;
+  }
+
+  void *data = chunk->items[0];
+
+  memmove(chunk->items, chunk->items + 1, (chunk->count - 1) * sizeof(void*));
+  --list->length;
+
+  if (--chunk->count == 0) {
+    remove_chunk(list, chunk);
+  }
+
+  return data;
+}
+
+
+/**
+ * @returns last payload or NULL if list is empty
+ */
+void *unrolled_list_pop_tail(unrolled_list_t *list) {
+
+  unrolled_chunk_t *chunk = list->tail;
+
+  if (!chunk) {
+    return NULL;
+  }
+
+  void *data = chunk->items[--chunk->count];
+  --list->length;
+
+  if (chunk->count == 0) {
+    remove_chunk(list, chunk);
+  }
+
+  return data;
+}
+
+
+/**
+ * @function Inserts payload before position, invalid position means the end
+ * @brief Full chunk is split in halves first. Position points to the
+ *        inserted payload after the call
+ * @returns 0 on success, -1 if error
+ */
+int unrolled_list_insert(unrolled_list_t *list, unrolled_iterator_t *position, void *data) {
+
+  if (!position->chunk) {
+
+    if (unrolled_list_push_tail(list, data)) {
+      return -1;
+    }
+
+    position->chunk = list->tail;
+    position->index = list->tail->count - 1;
+
+    return 0;
+  }
+
+  unrolled_chunk_t *chunk = position->chunk;
+  size_t index = position->index;
+
+  if (chunk->count == UNROLLED_CHUNK_CAPACITY) {
+
+    unrolled_chunk_t *new_chunk = init_unrolled_chunk();
+    if (!new_chunk) {
+      return -1;
+    }
+
+    size_t half = UNROLLED_CHUNK_CAPACITY / 2;
+
+    link_chunk_after(list, chunk, new_chunk);
+    memcpy(new_chunk->items, chunk->items + half, (chunk->count - half) * sizeof(void*));
+    new_chunk->count = chunk->count - half;
+    chunk->count = half;
+
+    if (index > half) {
+      chunk = new_chunk;
+      index -= half;
+    }
+  }
+
+  memmove(chunk->items + index + 1, chunk->items + index, (chunk->count - index) * sizeof(void*));
+  chunk->items[index] = data;
+  ++chunk->count;
+  ++list->length;
+
+  position->chunk = chunk;
+  position->index = index;
+
+  return 0;
+}
+
+
+/**
+ * @function Removes payload at position
+ * @brief Chunk less than half full is merged with its neighbour, if they
+ *        fit in one chunk. Position points to the next payload after the call
+ * @returns removed payload
+ */
+void *unrolled_list_remove(unrolled_list_t *list, unrolled_iterator_t *position) {
+
+  unrolled_chunk_t *chunk = position->chunk;
+  size_t index = position->index;
+
+  void *data = chunk->items[index];
+
+  memmove(chunk->items + index, chunk->items + index + 1, (chunk->count - index - 1) * sizeof(void*));
+  --chunk->count;
+  --list->length;
+
+  if (chunk->count == 0) {
+    position->chunk = chunk->next;
+    position->index = 0;
+    remove_chunk(list, chunk);
+    return data;
+  }
+
+  if (chunk->count < UNROLLED_CHUNK_CAPACITY / 2) {
+
+    unrolled_chunk_t *next_chunk = chunk->next;
+    unrolled_chunk_t *prev_chunk = chunk->prev;
+
+    if (next_chunk && chunk->count + next_chunk->count <= UNROLLED_CHUNK_CAPACITY) {
+      merge_chunks(list, chunk, next_chunk);
+    } else if (prev_chunk && prev_chunk->count + chunk->count <= UNROLLED_CHUNK_CAPACITY) {
+      index += prev_chunk->count;
+      merge_chunks(list, prev_chunk, chunk);
+      chunk = prev_chunk;
+    }
+  }
+
+  if (index == chunk->count) {
+    chunk = chunk->next;
+    index = 0;
+  }
+
+  position->chunk = chunk;
+  position->index = index;
+
+  return data;
+}
@@ -0,0 +1,134 @@
+#include <stddef.h>
+
+
+/*
+ * Unrolled linked list
+ *
+ * Each node is a cache line aligned chunk, that keeps several
+ * payloads packed at its start, so iteration touches one line per
+ * few payloads instead of one node and one data cell per payload.
+ * Full chunk is split in halves on insert, chunk less than half full
+ * is merged with its neighbour on remove.
+ */
+
+
+#define UNROLLED_CHUNK_SIZE 128
+#define UNROLLED_CHUNK_CAPACITY ((UNROLLED_CHUNK_SIZE - 2 * sizeof(void*) - sizeof(size_t)) / sizeof(void*))
+
+
+/**
+ * @struct Chunk of unrolled list
+ *
+ * @prop {count} number of payloads in items[0, count)
+ */
+typedef struct unrolled_chunk_t_ {
+  struct unrolled_chunk_t_ *prev;
+  struct unrolled_chunk_t_ *next;
+  size_t count;
+  void *items[UNROLLED_CHUNK_CAPACITY];
+} unrolled_chunk_t;
+
+
+/**
+ * @struct Unrolled list
+ *
+ * @prop {head} first chunk, NULL if list is empty
+ * @prop {tail} last chunk, NULL if list is empty
+ * @prop {length} number of payloads
+ */
+typedef struct {
+  unrolled_chunk_t *head;
+  unrolled_chunk_t *tail;
+  size_t length;
+} unrolled_list_t;
+
+
+/**
+ * @struct Position in unrolled list, chunk is NULL past the end
+ */
+typedef struct {
+  unrolled_chunk_t *chunk;
+  size_t index;
+} unrolled_iterator_t;
+
+
+unrolled_list_t *init_unrolled_list();
+
+
+void close_unrolled_list(unrolled_list_t *list, void (*free_func)(void*));
+
+
+int unrolled_list_push_head(unrolled_list_t *list, void *data);
+
+
+int unrolled_list_push_tail(unrolled_list_t *list, void *data);
+
+
+void *unrolled_list_pop_head(unrolled_list_t *list);
+
+
+void *unrolled_list_pop_tail(unrolled_list_t *list);
+
+
+int unrolled_list_insert(unrolled_list_t *list, unrolled_iterator_t *position, void *data);
+
+
+void *unrolled_list_remove(unrolled_list_t *list, unrolled_iterator_t *position);
+
+
+static inline size_t get_unrolled_list_length(unrolled_list_t *list) {
+  return list->length;
+}
+
+
+static inline int is_unrolled_list_empty(unrolled_list_t *list) {
+  return list->length == 0;
+}
+
+
+/**
+ * @function prefetches chunk after the one iteration enters
+ */
+static inline void prefetch_unrolled_chunk(unrolled_chunk_t *chunk) {
+  if (chunk) {
+    __builtin_prefetch(chunk->next);
+  }
+}
+
+
+static inline unrolled_iterator_t get_unrolled_list_begin(unrolled_list_t *list) {
+  prefetch_unrolled_chunk(list->head);
+  return (unrolled_iterator_t) { list->head, 0 };
+}
+
+
+static inline int is_unrolled_iterator_valid(unrolled_iterator_t *iterator) {
+  return iterator->chunk != NULL;
+}
+
+
+static inline void *get_unrolled_iterator_data(unrolled_iterator_t *iterator) {
+  return iterator->chunk->items[iterator->index];
+}
+
+
+static inline void move_unrolled_iterator_next(unrolled_iterator_t *iterator) {
+  if (++iterator->index == iterator->chunk->count) {
+    iterator->chunk = iterator->chunk->next;
+    iterator->index = 0;
+    prefetch_unrolled_chunk(iterator->chunk);
+  }
+}
+
+
+/**
+ * @function calls func for every payload from head to tail
+ */
+static inline void for_each_in_unrolled_list(unrolled_list_t *list, void (*func)(void*, void*), void *arg) {
+  for (unrolled_chunk_t *chunk = list->head; chunk; chunk = chunk->next) {
+    prefetch_unrolled_chunk(chunk);
+    for (size_t i = 0; i < chunk->count; ++i) {
+      func(chunk->items[i], arg);
+    }
+  }
+}
@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef ST_LIST_
+#define ST_LIST_
+#include "list.h"
+#endif
+
+#ifndef ST_UNROLLED_LIST_
+#define ST_UNROLLED_LIST_
+#include "unrolled_list.h"
+#endif
+
+
+// ------------------------------------------------------
+// --------------------- Benchmarks ---------------------
+// ------------------------------------------------------
+
+
+const int TEST_OPERATIONS = 200000;
+const long TRAVERSED_ITEMS_PER_SIZE = 50000000;
+
+
+static double get_time_diff_sec(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+
+static void do_nothing(void *data) {
+  (void) data;
+}
+
+
+/**
+ * @function random pushes, pops, inserts and removes, mirrored by plain array
+ * @returns  0 if list and array agree
+ */
+int test_unrolled_list_operations() {
+
+  unrolled_list_t *list = init_unrolled_list();
+  long *model = (long*) malloc(sizeof(long) * TEST_OPERATIONS);
+  size_t model_length = 0;
+
+  srand(42);
+
+  for (long i = 0; i < TEST_OPERATIONS; ++i) {
+
+    int operation = rand() % 6;
+
+    if (operation == 0) {
+      unrolled_list_push_head(list, (void*) i);
+      for (size_t j = model_length; j > 0; --j) {
+        model[j] = model[j - 1];
+      }
+      model[0] = i;
+      ++model_length;
+    } else if (operation == 1) {
+      unrolled_list_push_tail(list, (void*) i);
+      model[model_length++] = i;
+    } else if (operation == 2 && model_length) {
+      unrolled_list_pop_head(list);
+      for (size_t j = 1; j < model_length; ++j) {
+        model[j - 1] = model[j];
+      }
+      --model_length;
+    } else if (operation == 3 && model_length) {
+      unrolled_list_pop_tail(list);
+      --model_length;
+    } else if (operation == 4 || operation == 5) {
+
+      // walk to random position, then insert or remove there
+      size_t target = model_length ? rand() % (model_length + (operation == 4)) : 0;
+
+      unrolled_iterator_t position = get_unrolled_list_begin(list);
+      for (size_t j = 0; j < target; ++j) {
+        move_unrolled_iterator_next(&position);
+      }
+
+      if (operation == 4) {
+        unrolled_list_insert(list, &position, (void*) i);
+        for (size_t j = model_length; j > target; --j) {
+          model[j] = model[j - 1];
+        }
+        model[target] = i;
+        ++model_length;
+      } else if (model_length) {
+        unrolled_list_remove(list, &position);
+        for (size_t j = target + 1; j < model_length; ++j) {
+          model[j - 1] = model[j];
+        }
+        --model_length;
+
+        // iterator should point to the next payload
+        if (target < model_length && (long) get_unrolled_iterator_data(&position) != model[target]) {
+          printf("test_unrolled_list_operations: Failure. Iterator after remove\n");
+          return 1;
+        }
+      }
+    }
+
+    // keep list short, so the mirror stays cheap
+    if (model_length > 2000) {
+      while (model_length > 1000) {
+        unrolled_list_pop_tail(list);
+        --model_length;
+      }
+    }
+  }
+
+  size_t index = 0;
+  int is_equal = get_unrolled_list_length(list) == model_length;
+
+  for (unrolled_iterator_t it = get_unrolled_list_begin(list); is_unrolled_iterator_valid(&it); move_unrolled_iterator_next(&it)) {
+    is_equal = is_equal && index < model_length && (long) get_unrolled_iterator_data(&it) == model[index];
+    ++index;
+  }
+
+  close_unrolled_list(list, NULL);
+  free(model);
+
+  if (!is_equal || index != model_length) {
+    printf("test_unrolled_list_operations: Failure\n");
+    return 1;
+  }
+
+  printf("test_unrolled_list_operations: Success\n");
+
+  return 0;
+}
+
+
+/**
+ * @function sums payloads of list_t and of unrolled list of the same size
+ * @returns  0 if sums are equal
+ */
+int bench_traversal(long number_of_items) {
+
+  list_t *list = init_list();
+  unrolled_list_t *unrolled_list = init_unrolled_list();
+
+  for (long i = 0; i < number_of_items; ++i) {
+    add_item_to_tail_of_list(list, init_list_item_data((void*) i, do_nothing));
+    unrolled_list_push_tail(unrolled_list, (void*) i);
+  }
+
+  long rounds = TRAVERSED_ITEMS_PER_SIZE / number_of_items;
+  long list_sum = 0;
+  long unrolled_list_sum = 0;
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (long round = 0; round < rounds; ++round) {
+    for (list_item_t *item = get_list_head(list)->next; item != get_list_tail(list); item = item->next) {
+      list_sum += (long) get_list_item_data(item);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double list_sec = get_time_diff_sec(&start, &end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (long round = 0; round < rounds; ++round) {
+    for (unrolled_iterator_t it = get_unrolled_list_begin(unrolled_list);
+         is_unrolled_iterator_valid(&it); move_unrolled_iterator_next(&it)) {
+      unrolled_list_sum += (long) get_unrolled_iterator_data(&it);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double unrolled_list_sec = get_time_diff_sec(&start, &end);
+
+  printf("%9ld items: list_t %6.2f ns/item, unrolled_list_t %6.2f ns/item\n", number_of_items,
+         list_sec / (rounds * number_of_items) * 1e9,
+         unrolled_list_sec / (rounds * number_of_items) * 1e9);
+
+  close_list(list);
+  close_unrolled_list(unrolled_list, NULL);
+
+  return list_sum == unrolled_list_sum ? 0 : 1;
+}
+
+
+int main() {
+
+  int result = test_unrolled_list_operations();
+
+  for (long number_of_items = 10000; number_of_items <= 10000000; number_of_items *= 10) {
+    result |= bench_traversal(number_of_items);
+  }
+
+  return result;
+}